@@ -2,6 +2,7 @@
 
 #include "vmlinux.h"
 #include <bpf/bpf_helpers.h>
+#include "backoff.h"
 #include "protocol.bpf.h"
 #include "task_metadata.bpf.h"
 
@@ -22,6 +23,15 @@ struct {
     __type(value, struct prev_counters);
 } prev_counters_map SEC(".maps");
 
+// Per-CPU backoff state for shedding measurement output while the perf
+// buffer is full (see backoff.h)
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct backoff_state);
+} backoff_state_map SEC(".maps");
+
 // Declare the perf event arrays
 struct {
     __uint(type, BPF_MAP_TYPE_PERF_EVENT_ARRAY);
@@ -115,8 +125,19 @@ int measure_perf(struct trace_event_raw_sched_switch *ctx) {
     if (prev->timestamp != 0) {
         params.time_delta_ns = compute_delta(now, prev->timestamp);
         params.timestamp = now;
-        // Submit the event using the helper function
-        send_perf_measurement(ctx, &params);
+        // Probabilistically skip the emission while the output buffer is
+        // full; counters in prev_counters_map keep advancing either way,
+        // so later deltas stay correct
+        struct backoff_state *backoff = bpf_map_lookup_elem(&backoff_state_map, &zero);
+        if (!backoff || backoff_should_try(backoff, bpf_get_prandom_u32())) {
+            err = send_perf_measurement(ctx, &params);
+            if (backoff) {
+                if (err == 0)
+                    backoff_update_success(backoff);
+                else
+                    backoff_update_failure(backoff);
+            }
+        }
     }
     prev->timestamp = now;
     
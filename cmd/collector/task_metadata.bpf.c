@@ -7,6 +7,7 @@
 #include "protocol.bpf.h"
 
 struct task_metadata_storage_map task_metadata_storage SEC(".maps");
+struct metadata_reported_cache_map metadata_reported_cache SEC(".maps");
 
 // Initialize value to be stored in task storage for new tasks
 static const __u64 TASK_METADATA_INIT = 0;  // 0 = not reported yet
@@ -12,6 +12,35 @@ struct task_metadata_storage_map {
 };
 extern struct task_metadata_storage_map task_metadata_storage SEC(".maps");
 
+// Small per-CPU cache of recently-confirmed-reported processes, checked
+// before the task storage lookup. In steady state the same handful of
+// processes run on a CPU back to back, so most checks resolve with two
+// compares against a per-CPU array entry instead of a task-local-storage
+// lookup plus an atomic. Direct-mapped by tgid; entries are never
+// invalidated - start_time disambiguates a reused tgid, since the new
+// process's start time differs from the cached one and the check falls
+// through to task storage.
+#define METADATA_CACHE_SLOTS 16
+
+struct metadata_cache_entry {
+    __u32 tgid;
+    __u64 start_time;
+};
+
+struct metadata_reported_cache_map {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, METADATA_CACHE_SLOTS);
+    __type(key, __u32);
+    __type(value, struct metadata_cache_entry);
+};
+extern struct metadata_reported_cache_map metadata_reported_cache SEC(".maps");
+
+// Return this CPU's cache slot for a tgid (NULL only if the lookup fails,
+// which cannot happen for an in-bounds per-CPU array key)
+static __always_inline struct metadata_cache_entry *metadata_cache_slot(__u32 tgid) {
+    __u32 slot = tgid & (METADATA_CACHE_SLOTS - 1);
+    return bpf_map_lookup_elem(&metadata_reported_cache, &slot);
+}
 
 // Helper function to check if a task is a kernel thread
 static __always_inline int is_kernel_thread(struct task_struct *task) {
@@ -32,22 +61,35 @@ static __always_inline int should_send_task_metadata(struct task_struct *task) {
     // Skip kernel threads (redundant check, also done in the caller)
     if (is_kernel_thread(task))
         return 0;
-    
+
+    // Fast path: recently confirmed reported on this CPU
+    __u32 tgid = task->tgid;
+    __u64 start_time = task->start_time;
+    struct metadata_cache_entry *cached = metadata_cache_slot(tgid);
+    if (cached && cached->tgid == tgid && cached->start_time == start_time)
+        return 0;
+
     // Get or create metadata tracking entry
-    __u64 *reported = bpf_task_storage_get(&task_metadata_storage, task, 
-                                          NULL, 
+    __u64 *reported = bpf_task_storage_get(&task_metadata_storage, task,
+                                          NULL,
                                           BPF_LOCAL_STORAGE_GET_F_CREATE);
-    
+
     if (!reported)
         return 0;
-    
+
     // Use atomic compare-and-swap to check and update the reported status
     // If it returns 0, we were the ones who changed it from 0->1
-    if (__sync_val_compare_and_swap(reported, 0, 1) == 0) {
+    // Either way the task is reported after the CAS, so cache it
+    __u64 prev = __sync_val_compare_and_swap(reported, 0, 1);
+    if (cached) {
+        cached->tgid = tgid;
+        cached->start_time = start_time;
+    }
+    if (prev == 0) {
         // We're the first to report this task
         return 1;
     }
-    
+
     return 0;
 }
 
@@ -1,15 +1,42 @@
 package main
 
 import (
+	"flag"
 	"net/http"
-    "github.com/prometheus/client_golang/prometheus/promhttp"
+	"os"
+
+	"github.com/prometheus/client_golang/prometheus/promhttp"
 )
 
+// bpfTextfile is the path where the collector publishes its BPF probe
+// duration histograms in Prometheus text format (see the collector's
+// --probe-timing-textfile flag). The contents are appended to the /metrics
+// response so both sources are scraped from one endpoint.
+var bpfTextfile = flag.String("bpf-textfile", "",
+	"Prometheus textfile published by the collector's --probe-timing-textfile flag, appended to /metrics")
+
+// withTextfile serves the wrapped handler's output followed by the
+// contents of the configured textfile, if present
+func withTextfile(next http.Handler, path string) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		next.ServeHTTP(w, r)
+		if path == "" {
+			return
+		}
+		contents, err := os.ReadFile(path)
+		if err != nil {
+			// The collector may not have published yet; serve what we have
+			return
+		}
+		w.Write(contents)
+	})
+}
 
 func main() {
+	flag.Parse()
+
 	go recordMetrics()
-	
-	http.Handle("/metrics", promhttp.Handler())
+
+	http.Handle("/metrics", withTextfile(promhttp.Handler(), *bpfTextfile))
 	http.ListenAndServe(":2112", nil)
 }
-
@@ -13,6 +13,7 @@ import (
 	"math/bits"
 	"os"
 	"os/signal"
+	"sort"
 	"syscall"
 	"time"
 
@@ -151,6 +152,11 @@ func main() {
 		sumSquaredDelta uint64
 	})
 
+	// All observed deltas, for percentile reporting, plus a log2 histogram
+	// of fire-time error (bucket 0 = exact, bucket i = [2^(i-1), 2^i) ns)
+	var allDeltas []uint64
+	var log2Histogram [64]uint64
+
 	for !reader.Empty() {
 		// Get current ring
 		ring, _, err := reader.CurrentRing()
@@ -186,6 +192,13 @@ func main() {
 		}
 		tickStats[event.TickNumber] = stats
 
+		allDeltas = append(allDeltas, event.Delta)
+		bucket := 0
+		if event.Delta > 0 {
+			bucket = bits.Len64(event.Delta)
+		}
+		log2Histogram[bucket]++
+
 		// Consume the event
 		if err := reader.Pop(); err != nil {
 			fmt.Printf("Error consuming event: %v\n", err)
@@ -238,5 +251,32 @@ func main() {
 		fmt.Printf("Average Delta: %.2f ns\n", avgDelta)
 		fmt.Printf("Minimum Delta: %d ns\n", minDelta)
 		fmt.Printf("Maximum Delta: %d ns\n", maxDelta)
+
+		sort.Slice(allDeltas, func(i, j int) bool { return allDeltas[i] < allDeltas[j] })
+		fmt.Printf("p50 Delta: %d ns\n", percentile(allDeltas, 0.50))
+		fmt.Printf("p99 Delta: %d ns\n", percentile(allDeltas, 0.99))
+		fmt.Printf("p999 Delta: %d ns\n", percentile(allDeltas, 0.999))
+
+		fmt.Printf("\nFire-time error histogram (log2 buckets):\n")
+		for bucket, count := range log2Histogram {
+			if count == 0 {
+				continue
+			}
+			lower, upper := uint64(0), uint64(0)
+			if bucket > 0 {
+				lower = uint64(1) << (bucket - 1)
+				upper = uint64(1)<<bucket - 1
+			}
+			fmt.Printf("  %12d - %12d ns: %d\n", lower, upper, count)
+		}
+	}
+}
+
+// percentile returns the value at the given quantile of a sorted slice
+func percentile(sorted []uint64, q float64) uint64 {
+	if len(sorted) == 0 {
+		return 0
 	}
+	idx := int(q * float64(len(sorted)-1))
+	return sorted[idx]
 }
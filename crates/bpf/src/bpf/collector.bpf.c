@@ -3,6 +3,7 @@
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_core_read.h>
 
+#include "backoff.h"
 #include "collector.h"
 #include "sync_timer.bpf.h"
 // Map to track which tasks have had metadata reported
@@ -13,13 +14,27 @@ struct {
     __type(value, __u64);
 } task_metadata_storage SEC(".maps");
 
-// Hash map to track exited group leaders that need to be reported during process_free
+// Small per-CPU cache of recently-confirmed-reported processes, checked
+// before the task storage lookup in check_and_send_metadata. In steady state
+// the same handful of processes run on a CPU back to back, so most checks
+// resolve with two compares against a per-CPU array entry instead of a
+// task-local-storage lookup plus an atomic. Direct-mapped by tgid; entries
+// are never invalidated - start_time disambiguates a reused tgid, since the
+// new process's start time differs from the cached one and the check falls
+// through to task storage.
+#define METADATA_CACHE_SLOTS 16
+
+struct metadata_cache_entry {
+    __u32 tgid;
+    __u64 start_time;
+};
+
 struct {
-    __uint(type, BPF_MAP_TYPE_HASH);
-    __uint(max_entries, 8192);
-    __type(key, __u32);  // PID of the exited group leader
-    __type(value, __u8); // Just a presence indicator
-} exited_leaders SEC(".maps");
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, METADATA_CACHE_SLOTS);
+    __type(key, __u32);
+    __type(value, struct metadata_cache_entry);
+} metadata_reported_cache SEC(".maps");
 
 // Performance event output for events
 struct {
@@ -28,6 +43,266 @@ struct {
     __uint(value_size, sizeof(u32));
 } events SEC(".maps");
 
+// Shared ring buffer output for events, used instead of the per-CPU perf
+// buffers when `use_ringbuf` is set. The loader may resize this before load
+// based on the number of CPUs.
+struct {
+    __uint(type, BPF_MAP_TYPE_RINGBUF);
+    __uint(max_entries, 4 * 1024 * 1024);
+} events_ringbuf SEC(".maps");
+
+// Selects the events output transport at load time. Set by the loader before
+// load so the verifier eliminates the unused output path.
+const volatile __u32 use_ringbuf = 0;
+
+// Enabled counter set, specialized at load time. The loader sets these
+// before load, so the verifier dead-code-eliminates the reads of disabled
+// counters instead of branching on them at runtime.
+const volatile __u32 counter_cycles_enabled = 1;
+const volatile __u32 counter_instructions_enabled = 1;
+const volatile __u32 counter_llc_misses_enabled = 1;
+const volatile __u32 counter_cache_references_enabled = 1;
+
+// Aggregate measurements per tgid in kernel and flush once per sync-timer
+// tick, instead of emitting one message per sched_switch. Requires the ring
+// buffer transport: the flush iterates the aggregation map with
+// bpf_for_each_map_elem, whose callback has no tracepoint context to pass to
+// bpf_perf_event_output.
+const volatile __u32 aggregate_in_kernel = 0;
+
+// Roll measurements up to the cgroup level instead of per tgid. A container
+// runs tens of tgids that all share one cgroup, so keying the aggregation map
+// by bpf_get_current_cgroup_id() collapses them into a single record per tick.
+// Only meaningful together with aggregate_in_kernel.
+const volatile __u32 aggregate_by_cgroup = 0;
+
+// Emit measurements in the compact 32-bit-delta encoding (see
+// compact_perf_measurement_msg in collector.h), shrinking each message from
+// 88 to 64 bytes. Measurements whose deltas overflow 32 bits automatically
+// escape to the full format.
+const volatile __u32 compact_measurements = 0;
+
+// Minimum context-switch slice duration to emit immediately, in nanoseconds.
+// Shorter slices are held back and folded into the next measurement for the
+// same tgid, capping the event rate under high-frequency switching (e.g.
+// futex ping-pong producing 2-5us slices). No counted cycles are lost: the
+// held-back deltas ride along with the tgid's next message. Zero disables
+// suppression; set by the loader before load so the verifier eliminates the
+// checks when unused.
+const volatile __u64 min_slice_ns = 0;
+
+// Tickless idle mode: when a CPU sees consecutive ticks without a single
+// sched_switch, the sync timer stretches its own interval exponentially (up
+// to TICKLESS_MAX_SHIFT doublings) instead of waking an idle CPU 1000
+// times a second. The sched_switch path snaps the timer back to the base
+// interval as soon as work appears. Measurement fidelity is unaffected: an
+// idle CPU has nothing to attribute.
+const volatile __u32 tickless_idle = 0;
+
+// Cap the stretched interval at 2^6 = 64 base intervals (64ms)
+#define TICKLESS_MAX_SHIFT 6
+
+// Per-CPU idle tracking for the tickless mode
+struct idle_state {
+    __u32 switches_since_tick;  // sched_switch count since the last timer tick
+    __u32 idle_ticks;           // Consecutive ticks without a sched_switch
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct idle_state);
+} idle_states SEC(".maps");
+
+// Adaptive tick rate: a per-CPU feedback controller driven by recent
+// sched_switch and output-drop rates picks each CPU's next tick interval.
+// sync_timer_interval_ns is the floor; the ceiling is the floor shifted
+// left by adaptive_max_shift (e.g. a 500us floor with shift 5 gives a 16ms
+// ceiling). Busy, healthy CPUs run at the floor for measurement fidelity;
+// quiet CPUs back off one doubling per tick as in the tickless mode; CPUs
+// whose outputs are dropping back off to shed the collector's own overhead
+// while the node is overloaded. Interval changes are reported in the output
+// stream (MSG_TYPE_TICK_INTERVAL_CHANGE) so downstream timeslot assembly
+// knows each CPU's cadence. Supersedes tickless_idle.
+const volatile __u32 adaptive_tick = 0;
+
+// Interval ceiling, in power-of-two multiples of the base interval
+const volatile __u32 adaptive_max_shift = 4;
+
+// Switches per tick at or above which a CPU runs at the floor interval
+const volatile __u32 adaptive_busy_switches = 8;
+
+// Per-CPU controller state
+struct adaptive_state {
+    __u32 shift;       // Current interval is the base interval << shift
+    __u32 shedding;    // Stretch is drop-driven: sched_switch must not snap back
+    __u32 pending;     // Interval change not yet reported to userspace
+    __u64 last_drops;  // This CPU's total drop count at the last tick
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct adaptive_state);
+} adaptive_states SEC(".maps");
+
+// Probe self-timing: when enabled, a sampled subset of handler executions
+// measures its own duration with bpf_ktime_get_ns at entry/exit and
+// accumulates per-CPU log2 histograms, so probe overhead regressions show
+// up in monitoring instead of in application latency. One in
+// 2^probe_timing_sample_shift invocations is timed, keeping the
+// instrumentation's own overhead in the noise.
+const volatile __u32 probe_timing_enabled = 0;
+const volatile __u32 probe_timing_sample_shift = 10;
+
+// Instrumented handlers
+enum probe_id {
+    PROBE_SCHED_SWITCH = 0,
+    PROBE_TIMER_TICK = 1,
+    NUM_PROBES = 2,
+};
+
+#define PROBE_DURATION_BUCKETS 64
+
+// Log2 duration histograms, NUM_PROBES x PROBE_DURATION_BUCKETS entries
+// (probe_id * PROBE_DURATION_BUCKETS + bucket)
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, NUM_PROBES * PROBE_DURATION_BUCKETS);
+    __type(key, __u32);
+    __type(value, __u64);
+} probe_duration_hist SEC(".maps");
+
+// Total sampled nanoseconds per probe, for histogram sums
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, NUM_PROBES);
+    __type(key, __u32);
+    __type(value, __u64);
+} probe_duration_sum SEC(".maps");
+
+// Entry timestamp for a sampled handler execution, or 0 when this
+// invocation is not sampled
+static __always_inline __u64 probe_timing_start(void)
+{
+    if (!probe_timing_enabled)
+        return 0;
+    if (bpf_get_prandom_u32() & ((1u << probe_timing_sample_shift) - 1))
+        return 0;
+    return bpf_ktime_get_ns();
+}
+
+// Record the duration of a sampled handler execution
+static __always_inline void probe_timing_record(enum probe_id probe, __u64 start)
+{
+    if (!start)
+        return;
+
+    __u64 duration = bpf_ktime_get_ns() - start;
+    __u32 bucket = duration ? __sync_timer_log2(duration) + 1 : 0;
+    if (bucket >= PROBE_DURATION_BUCKETS)
+        bucket = PROBE_DURATION_BUCKETS - 1;
+
+    __u32 key = (__u32)probe * PROBE_DURATION_BUCKETS + bucket;
+    __u64 *count = bpf_map_lookup_elem(&probe_duration_hist, &key);
+    if (count)
+        *count += 1;
+
+    key = (__u32)probe;
+    __u64 *sum = bpf_map_lookup_elem(&probe_duration_sum, &key);
+    if (sum)
+        *sum += duration;
+}
+
+// A short slice held back for merging into the same tgid's next measurement
+// on this CPU
+struct pending_slice {
+    __u32 tgid;
+    __u32 valid;
+    __u32 next_tgid;  // next_tgid of the held-back context switch
+    __u64 cycles_delta;
+    __u64 instructions_delta;
+    __u64 llc_misses_delta;
+    __u64 cache_references_delta;
+    __u64 time_delta_ns;
+};
+
+// Per-CPU holding slot for the most recent suppressed short slice
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct pending_slice);
+} pending_slices SEC(".maps");
+
+// Accumulated counter deltas for one tgid on one CPU
+struct tgid_aggregate {
+    __u64 cycles_delta;
+    __u64 instructions_delta;
+    __u64 llc_misses_delta;
+    __u64 cache_references_delta;
+    __u64 time_delta_ns;
+    __u64 count;  // Number of accumulated measurements since the last flush
+};
+
+// Per-CPU accumulation of counter deltas keyed by tgid. Entries are zeroed
+// rather than deleted on flush: values are per-CPU, and deleting the key
+// would discard other CPUs' accumulations for the same tgid. The slot is
+// reclaimed when the process is freed (handle_process_free); without that,
+// every tgid ever observed would occupy a slot forever and process churn
+// would eventually fill the map.
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, 16384);
+    __type(key, __u32);  // tgid
+    __type(value, struct tgid_aggregate);
+} tgid_aggregates SEC(".maps");
+
+// Per-CPU accumulation of counter deltas keyed by cgroup ID, used instead of
+// tgid_aggregates when aggregate_by_cgroup is set. Same accumulator layout,
+// zero-on-flush discipline, and lifetime: slots are reclaimed when the
+// cgroup is released (handle_cgroup_release), since cgroup IDs are never
+// reused and abandoned slots would otherwise accumulate until the map is
+// full. Sized smaller since cgroups are far fewer than tgids.
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+    __uint(max_entries, 2048);
+    __type(key, __u64);  // cgroup ID
+    __type(value, struct tgid_aggregate);
+} cgroup_aggregates SEC(".maps");
+
+// Per-CPU backoff state for shedding context-switch emissions while the
+// output buffer is full, instead of burning CPU on attempts that will fail
+// anyway (see backoff.h)
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct backoff_state);
+} backoff_states SEC(".maps");
+
+// Per-CPU sequence number stamped into every outgoing sample header, so
+// userspace can detect dropped records in O(1) per message
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u64);
+} seq_counters SEC(".maps");
+
+// Per-CPU drop counters indexed by msg_type, incremented when an output
+// fails (perf buffer full or ring buffer reservation failure)
+#define DROP_COUNTER_ENTRIES (MSG_TYPE_TICK_INTERVAL_CHANGE + 1)
+
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, DROP_COUNTER_ENTRIES);
+    __type(key, __u32);
+    __type(value, __u64);
+} drop_counters SEC(".maps");
+
 // Timer firing state tracking
 enum timer_fire_state {
     TIMER_RESET = 0,
@@ -91,6 +366,25 @@ struct {
     __type(value, struct prev_counters);
 } prev_counters_map SEC(".maps");
 
+// Current tgid running on each CPU, updated on sched_switch. A plain array
+// indexed by CPU id (rather than a per-CPU map) so a CPU can read its
+// sibling hyperthread's entry for co-runner attribution.
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1024);
+    __type(key, __u32);
+    __type(value, __u32);
+} cpu_current_tgid SEC(".maps");
+
+// Sibling hyperthread of each CPU, populated by the loader from sysfs
+// topology. (__u32)-1 means the CPU has no sibling (SMT disabled).
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1024);
+    __type(key, __u32);
+    __type(value, __u32);
+} sibling_cpus SEC(".maps");
+
 // Dummy instances to make skeleton generation work
 enum msg_type msg_type_ = 0;
 struct task_metadata_msg task_metadata_msg_ = {0};
@@ -102,8 +396,6 @@ enum timer_fire_state timer_fire_state_ = 0;
 
 // Initialize value for task storage
 static const __u64 TASK_METADATA_INIT = 0;  // 0 = not reported yet
-// Value to store in the exited_leaders map
-static const __u8 LEADER_PRESENT = 1;
 
 // Helper function to check if a task is a kernel thread
 static __always_inline int is_kernel_thread(struct task_struct *task)
@@ -115,6 +407,61 @@ static __always_inline int is_kernel_thread(struct task_struct *task)
     return (task->flags & 0x00200000 /* PF_KTHREAD */) || !task->mm;
 }
 
+// Fill the common sample header. The size field is filled by the kernel on
+// the perf output path and by the sender on the ring buffer path.
+static __always_inline void fill_header(struct sample_header *header, enum msg_type type, __u64 timestamp)
+{
+    header->type = type;
+    header->timestamp = timestamp;
+    header->cpu = bpf_get_smp_processor_id();
+
+    // Stamp and advance this CPU's sequence number
+    __u32 zero = 0;
+    __u64 *seq = bpf_map_lookup_elem(&seq_counters, &zero);
+    if (seq) {
+        header->seq = (__u32)*seq;
+        *seq += 1;
+    } else {
+        header->seq = 0;
+    }
+}
+
+// Count a dropped message in this CPU's per-type drop counters
+static __always_inline void count_drop(enum msg_type type)
+{
+    __u32 key = type;
+    __u64 *count = bpf_map_lookup_elem(&drop_counters, &key);
+    if (count)
+        *count += 1;
+}
+
+// Sum this CPU's drop counters across message types
+static __always_inline __u64 count_total_drops(void)
+{
+    __u64 total = 0;
+    __u32 key;
+
+    for (key = 0; key < DROP_COUNTER_ENTRIES; key++) {
+        __u64 *count = bpf_map_lookup_elem(&drop_counters, &key);
+        if (count)
+            total += *count;
+    }
+    return total;
+}
+
+// Fill task metadata message fields
+// Note: collects the cgroup ID of the current task context using bpf_get_current_cgroup_id().
+static __always_inline void fill_task_metadata(struct task_metadata_msg *msg, struct task_struct *task)
+{
+    fill_header(&msg->header, MSG_TYPE_TASK_METADATA, bpf_ktime_get_ns());
+    msg->pid = task->pid;
+
+    bpf_probe_read_kernel_str(&msg->comm, sizeof(msg->comm), task->comm);
+
+    // Get cgroup ID for the current task
+    msg->cgroup_id = bpf_get_current_cgroup_id();
+}
+
 // Send task metadata to userspace
 // Note: This function should be called with the current task as it collects the cgroup ID
 // of the current task context using bpf_get_current_cgroup_id().
@@ -122,39 +469,77 @@ static __always_inline int send_task_metadata(void *ctx, struct task_struct *tas
 {
     if (!task)
         return 0;
-    
+
+    if (use_ringbuf) {
+        struct task_metadata_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_TASK_METADATA);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_task_metadata(msg, task);
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
     struct task_metadata_msg msg = {};
-    
-    msg.header.timestamp = bpf_ktime_get_ns();
-    msg.header.type = MSG_TYPE_TASK_METADATA;
-    // size field is filled by the kernel
-    msg.pid = task->pid;
-    
-    bpf_probe_read_kernel_str(&msg.comm, sizeof(msg.comm), task->comm);
-    
-    // Get cgroup ID for the current task
-    msg.cgroup_id = bpf_get_current_cgroup_id();
-    
+    fill_task_metadata(&msg, task);
+
     // Skip the size field (first 4 bytes) when sending
-    return bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, 
-                                ((void*)&msg) + sizeof(__u32), 
-                                sizeof(msg) - sizeof(__u32));
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_TASK_METADATA);
+    return err;
 }
 
 // Send task free event to userspace
 static __always_inline int send_task_free(void *ctx, __u32 pid)
 {
+    if (use_ringbuf) {
+        struct task_free_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_TASK_FREE);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_header(&msg->header, MSG_TYPE_TASK_FREE, bpf_ktime_get_ns());
+        msg->pid = pid;
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
     struct task_free_msg msg = {};
-    
-    msg.header.timestamp = bpf_ktime_get_ns();
-    msg.header.type = MSG_TYPE_TASK_FREE;
-    // size field is filled by the kernel
+
+    fill_header(&msg.header, MSG_TYPE_TASK_FREE, bpf_ktime_get_ns());
     msg.pid = pid;
-    
+
     // Skip the size field (first 4 bytes) when sending
-    return bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, 
-                                ((void*)&msg) + sizeof(__u32), 
-                                sizeof(msg) - sizeof(__u32));
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_TASK_FREE);
+    return err;
+}
+
+// Look up the tgid currently running on this CPU's sibling hyperthread.
+// Returns 0 when there is no sibling or nothing has been recorded yet.
+static __always_inline __u32 read_sibling_tgid(void)
+{
+    __u32 cpu = bpf_get_smp_processor_id();
+
+    __u32 *sibling = bpf_map_lookup_elem(&sibling_cpus, &cpu);
+    if (!sibling || *sibling == (__u32)-1)
+        return 0;
+
+    __u32 sibling_cpu = *sibling;
+    __u32 *tgid = bpf_map_lookup_elem(&cpu_current_tgid, &sibling_cpu);
+    if (!tgid)
+        return 0;
+
+    return *tgid;
 }
 
 // Helper function to compute delta with wraparound handling
@@ -162,47 +547,220 @@ static __always_inline __u64 compute_delta(__u64 current, __u64 previous) {
     return current - previous;
 }
 
+// Fill perf measurement message fields
+static __always_inline void fill_perf_measurement(struct perf_measurement_msg *msg, __u32 pid,
+                                                 __u64 cycles_delta, __u64 instructions_delta,
+                                                 __u64 llc_misses_delta, __u64 cache_references_delta,
+                                                 __u64 time_delta_ns, __u64 timestamp,
+                                                 __u32 is_context_switch, __u32 next_tgid,
+                                                 __u32 is_timer_tick, __u32 sibling_tgid)
+{
+    fill_header(&msg->header, MSG_TYPE_PERF_MEASUREMENT, timestamp);
+    msg->pid = pid;
+    msg->cycles_delta = cycles_delta;
+    msg->instructions_delta = instructions_delta;
+    msg->llc_misses_delta = llc_misses_delta;
+    msg->cache_references_delta = cache_references_delta;
+    msg->time_delta_ns = time_delta_ns;
+    msg->is_context_switch = is_context_switch;
+    msg->next_tgid = next_tgid;
+    msg->is_timer_tick = is_timer_tick;
+    msg->sibling_tgid = sibling_tgid;
+}
+
+// Fill compact perf measurement message fields. Callers must have verified
+// that all deltas fit in 32 bits.
+static __always_inline void fill_compact_perf_measurement(struct compact_perf_measurement_msg *msg,
+                                                          __u32 pid, __u64 cycles_delta,
+                                                          __u64 instructions_delta, __u64 llc_misses_delta,
+                                                          __u64 cache_references_delta, __u64 time_delta_ns,
+                                                          __u64 timestamp, __u32 is_context_switch,
+                                                          __u32 next_tgid, __u32 is_timer_tick,
+                                                          __u32 sibling_tgid)
+{
+    fill_header(&msg->header, MSG_TYPE_COMPACT_PERF_MEASUREMENT, timestamp);
+    msg->pid = pid;
+    msg->next_tgid = next_tgid;
+    msg->sibling_tgid = sibling_tgid;
+    msg->flags = (is_context_switch ? COMPACT_MEASUREMENT_FLAG_CONTEXT_SWITCH : 0) |
+                 (is_timer_tick ? COMPACT_MEASUREMENT_FLAG_TIMER_TICK : 0);
+    msg->cycles_delta = cycles_delta;
+    msg->instructions_delta = instructions_delta;
+    msg->llc_misses_delta = llc_misses_delta;
+    msg->cache_references_delta = cache_references_delta;
+    msg->time_delta_ns = time_delta_ns;
+}
+
+// Send a measurement in the compact encoding
+static __always_inline int send_compact_perf_measurement(void *ctx, __u32 pid, __u64 cycles_delta,
+                                                         __u64 instructions_delta, __u64 llc_misses_delta,
+                                                         __u64 cache_references_delta, __u64 time_delta_ns,
+                                                         __u64 timestamp, __u32 is_context_switch,
+                                                         __u32 next_tgid, __u32 is_timer_tick,
+                                                         __u32 sibling_tgid)
+{
+    if (use_ringbuf) {
+        struct compact_perf_measurement_msg *msg =
+            bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_COMPACT_PERF_MEASUREMENT);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_compact_perf_measurement(msg, pid, cycles_delta, instructions_delta, llc_misses_delta,
+                                      cache_references_delta, time_delta_ns, timestamp,
+                                      is_context_switch, next_tgid, is_timer_tick, sibling_tgid);
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
+    struct compact_perf_measurement_msg msg = {};
+    fill_compact_perf_measurement(&msg, pid, cycles_delta, instructions_delta, llc_misses_delta,
+                                  cache_references_delta, time_delta_ns, timestamp,
+                                  is_context_switch, next_tgid, is_timer_tick, sibling_tgid);
+
+    // Skip the size field (first 4 bytes) when sending
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_COMPACT_PERF_MEASUREMENT);
+    return err;
+}
+
 // Send perf measurement event to userspace
-static __always_inline int send_perf_measurement(void *ctx, __u32 pid, __u64 cycles_delta, 
+static __always_inline int send_perf_measurement(void *ctx, __u32 pid, __u64 cycles_delta,
                                                __u64 instructions_delta, __u64 llc_misses_delta,
                                                __u64 cache_references_delta, __u64 time_delta_ns, __u64 timestamp,
-                                               __u32 is_context_switch, __u32 next_tgid)
+                                               __u32 is_context_switch, __u32 next_tgid,
+                                               __u32 is_timer_tick, __u32 sibling_tgid)
 {
+    // Compact encoding, when negotiated and every delta fits in 32 bits;
+    // oversized measurements escape to the full format below
+    if (compact_measurements &&
+        ((cycles_delta | instructions_delta | llc_misses_delta |
+          cache_references_delta | time_delta_ns) >> 32) == 0)
+        return send_compact_perf_measurement(ctx, pid, cycles_delta, instructions_delta,
+                                             llc_misses_delta, cache_references_delta,
+                                             time_delta_ns, timestamp, is_context_switch,
+                                             next_tgid, is_timer_tick, sibling_tgid);
+
+    if (use_ringbuf) {
+        struct perf_measurement_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_PERF_MEASUREMENT);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_perf_measurement(msg, pid, cycles_delta, instructions_delta, llc_misses_delta,
+                              cache_references_delta, time_delta_ns, timestamp,
+                              is_context_switch, next_tgid, is_timer_tick, sibling_tgid);
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
     struct perf_measurement_msg msg = {};
-    
-    msg.header.timestamp = timestamp;
-    msg.header.type = MSG_TYPE_PERF_MEASUREMENT;
-    // size field is filled by the kernel
-    msg.pid = pid;
-    msg.cycles_delta = cycles_delta;
-    msg.instructions_delta = instructions_delta;
-    msg.llc_misses_delta = llc_misses_delta;
-    msg.cache_references_delta = cache_references_delta;
-    msg.time_delta_ns = time_delta_ns;
-    msg.is_context_switch = is_context_switch;
-    msg.next_tgid = next_tgid;
-    
+    fill_perf_measurement(&msg, pid, cycles_delta, instructions_delta, llc_misses_delta,
+                          cache_references_delta, time_delta_ns, timestamp,
+                          is_context_switch, next_tgid, is_timer_tick, sibling_tgid);
+
     // Skip the size field (first 4 bytes) when sending
-    return bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, 
-                                ((void*)&msg) + sizeof(__u32), 
-                                sizeof(msg) - sizeof(__u32));
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_PERF_MEASUREMENT);
+    return err;
+}
+
+// Accumulate a measurement into the per-CPU aggregation map instead of
+// emitting it immediately. Used in in-kernel aggregation mode.
+static __always_inline void accumulate_perf_measurement(__u32 tgid, __u64 cycles_delta,
+                                                       __u64 instructions_delta, __u64 llc_misses_delta,
+                                                       __u64 cache_references_delta, __u64 time_delta_ns)
+{
+    struct tgid_aggregate *agg = bpf_map_lookup_elem(&tgid_aggregates, &tgid);
+    if (!agg) {
+        struct tgid_aggregate zero = {};
+        // BPF_NOEXIST so a concurrent insert from another CPU is not clobbered
+        bpf_map_update_elem(&tgid_aggregates, &tgid, &zero, BPF_NOEXIST);
+        agg = bpf_map_lookup_elem(&tgid_aggregates, &tgid);
+        if (!agg) {
+            // Map full, drop the measurement
+            count_drop(MSG_TYPE_PERF_MEASUREMENT);
+            return;
+        }
+    }
+
+    agg->cycles_delta += cycles_delta;
+    agg->instructions_delta += instructions_delta;
+    agg->llc_misses_delta += llc_misses_delta;
+    agg->cache_references_delta += cache_references_delta;
+    agg->time_delta_ns += time_delta_ns;
+    agg->count += 1;
+}
+
+// Accumulate a measurement under the current task's cgroup ID. Called in the
+// context of the task being charged (sched_switch fires before current
+// changes; the timer tick charges the interrupted task), so
+// bpf_get_current_cgroup_id() names the cgroup the deltas belong to.
+static __always_inline void accumulate_cgroup_measurement(__u64 cycles_delta,
+                                                          __u64 instructions_delta, __u64 llc_misses_delta,
+                                                          __u64 cache_references_delta, __u64 time_delta_ns)
+{
+    __u64 cgroup_id = bpf_get_current_cgroup_id();
+
+    struct tgid_aggregate *agg = bpf_map_lookup_elem(&cgroup_aggregates, &cgroup_id);
+    if (!agg) {
+        struct tgid_aggregate zero = {};
+        // BPF_NOEXIST so a concurrent insert from another CPU is not clobbered
+        bpf_map_update_elem(&cgroup_aggregates, &cgroup_id, &zero, BPF_NOEXIST);
+        agg = bpf_map_lookup_elem(&cgroup_aggregates, &cgroup_id);
+        if (!agg) {
+            // Map full, drop the measurement
+            count_drop(MSG_TYPE_CGROUP_MEASUREMENT);
+            return;
+        }
+    }
+
+    agg->cycles_delta += cycles_delta;
+    agg->instructions_delta += instructions_delta;
+    agg->llc_misses_delta += llc_misses_delta;
+    agg->cache_references_delta += cache_references_delta;
+    agg->time_delta_ns += time_delta_ns;
+    agg->count += 1;
 }
 
 // Send timer migration detection event to userspace
 static __always_inline int send_timer_migration_alert(void *ctx, __u32 expected_cpu, __u32 actual_cpu)
 {
+    if (use_ringbuf) {
+        struct timer_migration_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_TIMER_MIGRATION_DETECTED);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_header(&msg->header, MSG_TYPE_TIMER_MIGRATION_DETECTED, bpf_ktime_get_ns());
+        msg->expected_cpu = expected_cpu;
+        msg->actual_cpu = actual_cpu;
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
     struct timer_migration_msg msg = {};
-    
-    msg.header.timestamp = bpf_ktime_get_ns();
-    msg.header.type = MSG_TYPE_TIMER_MIGRATION_DETECTED;
-    // size field is filled by the kernel
+
+    fill_header(&msg.header, MSG_TYPE_TIMER_MIGRATION_DETECTED, bpf_ktime_get_ns());
     msg.expected_cpu = expected_cpu;
     msg.actual_cpu = actual_cpu;
-    
+
     // Skip the size field (first 4 bytes) when sending
-    return bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, 
-                                ((void*)&msg) + sizeof(__u32), 
-                                sizeof(msg) - sizeof(__u32));
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_TIMER_MIGRATION_DETECTED);
+    return err;
 }
 
 // Check and report task metadata if needed
@@ -217,29 +775,56 @@ static __always_inline int check_and_send_metadata(void *ctx, struct task_struct
     struct task_struct *leader = task->group_leader;
     if (!leader)
         return 0;
-    
+
+    // Fast path: recently confirmed reported on this CPU
+    __u32 tgid = leader->tgid;
+    __u64 start_time = leader->start_time;
+    __u32 slot = tgid & (METADATA_CACHE_SLOTS - 1);
+    struct metadata_cache_entry *cached =
+        bpf_map_lookup_elem(&metadata_reported_cache, &slot);
+    if (cached && cached->tgid == tgid && cached->start_time == start_time)
+        return 0;
+
     // Get or create metadata tracking entry
-    __u64 *reported = bpf_task_storage_get(&task_metadata_storage, leader, 
-                                          (void *)&TASK_METADATA_INIT, 
+    __u64 *reported = bpf_task_storage_get(&task_metadata_storage, leader,
+                                          (void *)&TASK_METADATA_INIT,
                                           BPF_LOCAL_STORAGE_GET_F_CREATE);
-    
+
     if (!reported)
         return 0;
 
-    if (*reported == 1)
+    if (*reported == 1) {
+        // Already reported; remember it so the next check on this CPU
+        // skips the task storage lookup
+        if (cached) {
+            cached->tgid = tgid;
+            cached->start_time = start_time;
+        }
         return 0;
-    
+    }
+
     // Use atomic compare-and-swap to check and update the reported status
-    if (__sync_val_compare_and_swap(reported, 0, 1) == 0) {
+    // Either way the task is reported after the CAS, so cache it
+    __u64 prev = __sync_val_compare_and_swap(reported, 0, 1);
+    if (cached) {
+        cached->tgid = tgid;
+        cached->start_time = start_time;
+    }
+    if (prev == 0) {
         // We're the first to report this task
         return send_task_metadata(ctx, leader);
     }
-    
+
     return 0;
 }
 
-// Collect and report performance measurements
-static __always_inline int collect_and_send_perf_measurements(void *ctx, struct task_struct *task, __u32 is_context_switch, __u32 next_tgid)
+// Collect and report performance measurements. When is_timer_tick is set the
+// emitted message doubles as the tick boundary marker; returns 1 if such a
+// message was emitted, 0 otherwise (first event on a CPU, aggregation mode,
+// or output failure), so the caller can fall back to a standalone marker.
+static __always_inline int collect_and_send_perf_measurements(void *ctx, struct task_struct *task,
+                                                              __u32 is_context_switch, __u32 next_tgid,
+                                                              __u32 is_timer_tick)
 {
     // Skip if null task
     if (!task)
@@ -266,47 +851,254 @@ static __always_inline int collect_and_send_perf_measurements(void *ctx, struct
     __u64 cache_references_delta = 0;
     __u64 now = bpf_ktime_get_ns();
     __u64 time_delta_ns = 0;
-    
-    int err = bpf_perf_event_read_value(&cycles, BPF_F_CURRENT_CPU, &cycles_val, sizeof(cycles_val));
-    if (err == 0) {
-        cycles_delta = compute_delta(cycles_val.counter, prev->cycles);
-        prev->cycles = cycles_val.counter;
+    __u32 sibling_tgid = read_sibling_tgid();
+
+    int err;
+
+    if (counter_cycles_enabled) {
+        err = bpf_perf_event_read_value(&cycles, BPF_F_CURRENT_CPU, &cycles_val, sizeof(cycles_val));
+        if (err == 0) {
+            cycles_delta = compute_delta(cycles_val.counter, prev->cycles);
+            prev->cycles = cycles_val.counter;
+        }
     }
-    
-    err = bpf_perf_event_read_value(&instructions, BPF_F_CURRENT_CPU, &instructions_val, sizeof(instructions_val));
-    if (err == 0) {
-        instructions_delta = compute_delta(instructions_val.counter, prev->instructions);
-        prev->instructions = instructions_val.counter;
+
+    if (counter_instructions_enabled) {
+        err = bpf_perf_event_read_value(&instructions, BPF_F_CURRENT_CPU, &instructions_val, sizeof(instructions_val));
+        if (err == 0) {
+            instructions_delta = compute_delta(instructions_val.counter, prev->instructions);
+            prev->instructions = instructions_val.counter;
+        }
     }
-    
-    err = bpf_perf_event_read_value(&llc_misses, BPF_F_CURRENT_CPU, &llc_misses_val, sizeof(llc_misses_val));
-    if (err == 0) {
-        llc_misses_delta = compute_delta(llc_misses_val.counter, prev->llc_misses);
-        prev->llc_misses = llc_misses_val.counter;
+
+    if (counter_llc_misses_enabled) {
+        err = bpf_perf_event_read_value(&llc_misses, BPF_F_CURRENT_CPU, &llc_misses_val, sizeof(llc_misses_val));
+        if (err == 0) {
+            llc_misses_delta = compute_delta(llc_misses_val.counter, prev->llc_misses);
+            prev->llc_misses = llc_misses_val.counter;
+        }
     }
-    
-    err = bpf_perf_event_read_value(&cache_references, BPF_F_CURRENT_CPU, &cache_references_val, sizeof(cache_references_val));
-    if (err == 0) {
-        cache_references_delta = compute_delta(cache_references_val.counter, prev->cache_references);
-        prev->cache_references = cache_references_val.counter;
+
+    if (counter_cache_references_enabled) {
+        err = bpf_perf_event_read_value(&cache_references, BPF_F_CURRENT_CPU, &cache_references_val, sizeof(cache_references_val));
+        if (err == 0) {
+            cache_references_delta = compute_delta(cache_references_val.counter, prev->cache_references);
+            prev->cache_references = cache_references_val.counter;
+        }
     }
     
     // Compute time delta and update timestamp
     // If prev->timestamp is 0, this is the first event, don't emit it
+    int measurement_sent = 0;
     if (prev->timestamp != 0) {
         time_delta_ns = compute_delta(now, prev->timestamp);
-        send_perf_measurement(ctx, pid, cycles_delta, instructions_delta, 
-                              llc_misses_delta, cache_references_delta, time_delta_ns, now,
-                              is_context_switch, next_tgid);
+
+        // Short-slice suppression: merge any held-back slice for this tgid
+        // into the current deltas, flush a held-back slice for another tgid,
+        // and hold this slice back if it is itself too short. Aggregation
+        // mode already coalesces per tgid, so suppression is skipped there.
+        if (min_slice_ns && !aggregate_in_kernel) {
+            struct pending_slice *pending = bpf_map_lookup_elem(&pending_slices, &zero);
+            if (pending) {
+                if (pending->valid && pending->tgid == pid) {
+                    cycles_delta += pending->cycles_delta;
+                    instructions_delta += pending->instructions_delta;
+                    llc_misses_delta += pending->llc_misses_delta;
+                    cache_references_delta += pending->cache_references_delta;
+                    time_delta_ns += pending->time_delta_ns;
+                    pending->valid = 0;
+                } else if (pending->valid) {
+                    // A different tgid ran next; emit the held-back slice
+                    // rather than holding it across other processes
+                    send_perf_measurement(ctx, pending->tgid, pending->cycles_delta,
+                                          pending->instructions_delta, pending->llc_misses_delta,
+                                          pending->cache_references_delta, pending->time_delta_ns,
+                                          now, 1, pending->next_tgid, 0, sibling_tgid);
+                    pending->valid = 0;
+                }
+
+                if (is_context_switch && !is_timer_tick && time_delta_ns < min_slice_ns) {
+                    pending->tgid = pid;
+                    pending->valid = 1;
+                    pending->next_tgid = next_tgid;
+                    pending->cycles_delta = cycles_delta;
+                    pending->instructions_delta = instructions_delta;
+                    pending->llc_misses_delta = llc_misses_delta;
+                    pending->cache_references_delta = cache_references_delta;
+                    pending->time_delta_ns = time_delta_ns;
+                    prev->timestamp = now;
+                    return 0;
+                }
+            }
+        }
+
+        if (aggregate_in_kernel) {
+            if (aggregate_by_cgroup)
+                accumulate_cgroup_measurement(cycles_delta, instructions_delta,
+                                              llc_misses_delta, cache_references_delta, time_delta_ns);
+            else
+                accumulate_perf_measurement(pid, cycles_delta, instructions_delta,
+                                            llc_misses_delta, cache_references_delta, time_delta_ns);
+        } else {
+            // Probabilistic load shedding: once outputs start failing,
+            // skip a growing fraction of context-switch emissions until
+            // they succeed again. Counter state in prev_counters_map keeps
+            // advancing either way; shed slices are counted as drops.
+            // Tick measurements always attempt since they carry the
+            // timeslot boundary marker.
+            struct backoff_state *backoff = bpf_map_lookup_elem(&backoff_states, &zero);
+            if (backoff && is_context_switch &&
+                !backoff_should_try(backoff, bpf_get_prandom_u32())) {
+                count_drop(MSG_TYPE_PERF_MEASUREMENT);
+            } else {
+                int err = send_perf_measurement(ctx, pid, cycles_delta, instructions_delta,
+                                                llc_misses_delta, cache_references_delta, time_delta_ns, now,
+                                                is_context_switch, next_tgid, is_timer_tick, sibling_tgid);
+                if (err == 0)
+                    measurement_sent = 1;
+                if (backoff) {
+                    if (err == 0)
+                        backoff_update_success(backoff);
+                    else
+                        backoff_update_failure(backoff);
+                }
+            }
+        }
     }
     prev->timestamp = now;
+
+    return measurement_sent;
+}
+
+__u64 sync_timer_callback(__u32 expected_cpu)
+{
+    // Set the timer fired flag for this CPU
+    __u32 key = 0;
+    __u32 actual_cpu = bpf_get_smp_processor_id();
     
-    return 0;
+    struct timer_fire_info info = {};
+    info.expected_cpu = expected_cpu;
+    
+    // Check if timer fired on the wrong CPU
+    if (actual_cpu != expected_cpu) {
+        info.state = TIMER_MIGRATION_DETECTED;
+    } else {
+        info.state = TIMER_FIRED;
+    }
+    
+    bpf_map_update_elem(&timer_fired, &key, &info, BPF_ANY);
+
+    // Adaptive mode: pick the next interval from this tick's switch and
+    // drop counts
+    if (adaptive_tick) {
+        struct adaptive_state *ast = bpf_map_lookup_elem(&adaptive_states, &key);
+        struct idle_state *idle = bpf_map_lookup_elem(&idle_states, &key);
+        if (!ast || !idle)
+            return 1;
+
+        __u32 switches = idle->switches_since_tick;
+        idle->switches_since_tick = 0;
+
+        __u64 drops = count_total_drops();
+        __u64 new_drops = drops - ast->last_drops;
+        ast->last_drops = drops;
+
+        __u32 shift = ast->shift;
+        if (new_drops > 0) {
+            // Outputs are dropping: shed the collector's own overhead
+            if (shift < adaptive_max_shift)
+                shift += 1;
+            ast->shedding = 1;
+        } else if (switches >= adaptive_busy_switches) {
+            // Busy and healthy: floor interval for measurement fidelity
+            shift = 0;
+            ast->shedding = 0;
+        } else if (switches == 0) {
+            // Quiet: back off one doubling per tick
+            if (shift < adaptive_max_shift)
+                shift += 1;
+            ast->shedding = 0;
+        } else {
+            // Light load: ease back toward the floor
+            if (shift > 0)
+                shift -= 1;
+            ast->shedding = 0;
+        }
+
+        if (shift != ast->shift) {
+            ast->shift = shift;
+            ast->pending = 1;
+        }
+        return 1ULL << (shift & 0x3f);
+    }
+
+    if (!tickless_idle)
+        return 1;
+
+    // Stretch the interval exponentially while this CPU stays idle
+    struct idle_state *idle = bpf_map_lookup_elem(&idle_states, &key);
+    if (!idle)
+        return 1;
+
+    if (idle->switches_since_tick) {
+        idle->switches_since_tick = 0;
+        idle->idle_ticks = 0;
+        return 1;
+    }
+
+    if (idle->idle_ticks < TICKLESS_MAX_SHIFT)
+        idle->idle_ticks += 1;
+
+    return 1ULL << idle->idle_ticks;
+}
+
+DEFINE_SYNC_TIMER(collect, sync_timer_callback);
+
+// Snap a stretched timer back to the next base-interval boundary as soon as
+// work appears on this CPU. In adaptive mode a drop-driven stretch stays
+// put: it exists precisely because the CPU is busy and the output path is
+// behind, so a sched_switch is no reason to speed back up.
+static __always_inline void timer_note_switch(void)
+{
+    if (!tickless_idle && !adaptive_tick)
+        return;
+
+    __u32 zero = 0;
+    struct idle_state *idle = bpf_map_lookup_elem(&idle_states, &zero);
+    if (!idle)
+        return;
+
+    idle->switches_since_tick += 1;
+
+    if (adaptive_tick) {
+        struct adaptive_state *ast = bpf_map_lookup_elem(&adaptive_states, &zero);
+        if (!ast || ast->shift == 0 || ast->shedding)
+            return;
+        ast->shift = 0;
+        ast->pending = 1;
+    } else {
+        if (idle->idle_ticks == 0)
+            return;  // Timer already at the base cadence
+        idle->idle_ticks = 0;
+    }
+
+    __u32 cpu = bpf_get_smp_processor_id();
+    struct sync_timer_state *state = bpf_map_lookup_elem(&sync_timer_states_collect, &cpu);
+    if (!state)
+        return;
+
+    __u64 offset = __sync_timer_phase_offset();
+    state->next_expected = __sync_timer_align_to_interval(
+        bpf_ktime_get_ns() - offset + sync_timer_interval_ns, sync_timer_interval_ns) + offset;
+    bpf_timer_start(&state->timer,
+                    __sync_timer_compute_start_param(state->next_expected, state->timer_flags),
+                    state->timer_flags);
 }
 
 SEC("tp_btf/sched_switch")
 int handle_sched_switch(u64 *ctx)
 {
+    __u64 probe_start = probe_timing_start();
     struct task_struct *prev = (struct task_struct *)ctx[1];
     struct task_struct *next = (struct task_struct *)ctx[2];
     
@@ -321,88 +1113,237 @@ int handle_sched_switch(u64 *ctx)
     
     // Check and send metadata if needed
     check_and_send_metadata(ctx, current_task);
-    
+
+    // Work appeared: snap a stretched timer back to the base cadence
+    timer_note_switch();
+
     // Collect and send performance measurements (context switch event)
-    collect_and_send_perf_measurements(ctx, current_task, 1, next_tgid);
-    
+    collect_and_send_perf_measurements(ctx, current_task, 1, next_tgid, 0);
+
+    // Record the incoming task so the sibling hyperthread can attribute
+    // its co-runner. Updated after the measurement, which covers the slice
+    // that just ended.
+    __u32 cpu = bpf_get_smp_processor_id();
+    bpf_map_update_elem(&cpu_current_tgid, &cpu, &next_tgid, BPF_ANY);
+
+    probe_timing_record(PROBE_SCHED_SWITCH, probe_start);
     return 0;
 }
 
-SEC("tracepoint/sched/sched_process_exit")
-int handle_process_exit(struct trace_event_raw_sched_process_template *ctx)
+SEC("tp_btf/sched_process_free")
+int handle_process_free(u64 *ctx)
 {
-    struct task_struct *task = bpf_get_current_task_btf();
+    struct task_struct *task = (struct task_struct *)ctx[0];
 
-    // Skip if not a group leader or kernel thread
+    // Only group leaders are reported to userspace
     if (!task || task != task->group_leader)
         return 0;
 
-    // Add task to the list of tasks to be reported
-    __u32 pid = task->pid;
-    bpf_map_update_elem(&exited_leaders, &pid, &LEADER_PRESENT, BPF_ANY);
+    // Reclaim the dead process's aggregation slot: the task is gone, so no
+    // CPU will accumulate into it again. At most the final partial tick's
+    // deltas are discarded. The delete covers all CPUs' values at once.
+    if (aggregate_in_kernel && !aggregate_by_cgroup) {
+        __u32 tgid = task->tgid;
+        bpf_map_delete_elem(&tgid_aggregates, &tgid);
+    }
+
+    // The pending-free marker is the task's own metadata-reported flag:
+    // only tasks whose metadata reached userspace have an entry to free
+    // there. Using the task storage avoids the hash insert the old
+    // exited_leaders map needed on every exit, which silently failed (and
+    // leaked userspace entries forever) once churn outpaced its 8192
+    // entries. The storage is still attached here since the task struct
+    // is only freed after this tracepoint fires.
+    __u64 *reported = bpf_task_storage_get(&task_metadata_storage, task, 0, 0);
+    if (!reported || *reported != 1)
+        return 0;
+
+    // Report task free event
+    send_task_free(ctx, task->pid);
 
     return 0;
 }
 
-
-SEC("tracepoint/sched/sched_process_free")
-int handle_process_free(struct trace_event_raw_sched_process_template *ctx)
+SEC("tp_btf/cgroup_release")
+int handle_cgroup_release(u64 *ctx)
 {
-    __u32 pid = ctx->pid;
-    
-    // Check if this is a registered group leader that needs reporting
-    __u8 *present = bpf_map_lookup_elem(&exited_leaders, &pid);
-    if (!present) {
-        // Not an exited group leader we care about
+    struct cgroup *cgrp = (struct cgroup *)ctx[0];
+
+    if (!aggregate_by_cgroup || !cgrp)
         return 0;
-    }
-    
-    // Remove from the tracking map
-    bpf_map_delete_elem(&exited_leaders, &pid);
-    
-    // Report task free event
-    send_task_free(ctx, pid);
-    
+
+    // Reclaim the released cgroup's aggregation slot. Release fires once
+    // the last reference is gone, after the last task left, so no CPU will
+    // accumulate under this ID again (unlike rmdir, where draining tasks
+    // could re-insert the entry). Cgroup IDs are never reused, so without
+    // this every cgroup that ever existed would occupy a slot forever.
+    __u64 cgroup_id = cgrp->kn->id;
+    bpf_map_delete_elem(&cgroup_aggregates, &cgroup_id);
+
     return 0;
 }
 
 // Send timer finished processing event to userspace
 static __always_inline int send_timer_finished_processing(void *ctx)
 {
+    if (use_ringbuf) {
+        struct timer_finished_processing_msg *msg =
+            bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_TIMER_FINISHED_PROCESSING);
+            return -1;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_header(&msg->header, MSG_TYPE_TIMER_FINISHED_PROCESSING, bpf_ktime_get_ns());
+        bpf_ringbuf_submit(msg, 0);
+        return 0;
+    }
+
     struct timer_finished_processing_msg msg = {};
-    
-    msg.header.timestamp = bpf_ktime_get_ns();
-    msg.header.type = MSG_TYPE_TIMER_FINISHED_PROCESSING;
-    
+
+    fill_header(&msg.header, MSG_TYPE_TIMER_FINISHED_PROCESSING, bpf_ktime_get_ns());
+
     // Skip the size field (first 4 bytes) when sending
-    return bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU, 
-                                ((void*)&msg) + sizeof(__u32), 
-                                sizeof(msg) - sizeof(__u32));
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err)
+        count_drop(MSG_TYPE_TIMER_FINISHED_PROCESSING);
+    return err;
 }
 
-void sync_timer_callback(__u32 expected_cpu)
+
+// Report this CPU's new tick interval to userspace once the adaptive
+// controller changed it. The pending flag stays set if the output fails,
+// so the report is retried on the next tick.
+static __always_inline void send_tick_interval_change(void *ctx)
 {
-    // Set the timer fired flag for this CPU
-    __u32 key = 0;
-    __u32 actual_cpu = bpf_get_smp_processor_id();
-    
-    struct timer_fire_info info = {};
-    info.expected_cpu = expected_cpu;
-    
-    // Check if timer fired on the wrong CPU
-    if (actual_cpu != expected_cpu) {
-        info.state = TIMER_MIGRATION_DETECTED;
-    } else {
-        info.state = TIMER_FIRED;
+    __u32 zero = 0;
+    struct adaptive_state *ast = bpf_map_lookup_elem(&adaptive_states, &zero);
+    if (!ast || !ast->pending)
+        return;
+
+    __u64 interval_ns = sync_timer_interval_ns << (ast->shift & 0x3f);
+
+    if (use_ringbuf) {
+        struct tick_interval_msg *msg =
+            bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+        if (!msg) {
+            count_drop(MSG_TYPE_TICK_INTERVAL_CHANGE);
+            return;
+        }
+        msg->header.size = sizeof(*msg);
+        fill_header(&msg->header, MSG_TYPE_TICK_INTERVAL_CHANGE, bpf_ktime_get_ns());
+        msg->interval_ns = interval_ns;
+        bpf_ringbuf_submit(msg, 0);
+        ast->pending = 0;
+        return;
     }
-    
-    bpf_map_update_elem(&timer_fired, &key, &info, BPF_ANY);
+
+    struct tick_interval_msg msg = {};
+
+    fill_header(&msg.header, MSG_TYPE_TICK_INTERVAL_CHANGE, bpf_ktime_get_ns());
+    msg.interval_ns = interval_ns;
+
+    // Skip the size field (first 4 bytes) when sending
+    int err = bpf_perf_event_output(ctx, &events, BPF_F_CURRENT_CPU,
+                                   ((void*)&msg) + sizeof(__u32),
+                                   sizeof(msg) - sizeof(__u32));
+    if (err) {
+        count_drop(MSG_TYPE_TICK_INTERVAL_CHANGE);
+        return;
+    }
+    ast->pending = 0;
+}
+
+// Context for the per-tick aggregation flush
+struct flush_ctx {
+    __u64 timestamp;
+};
+
+// bpf_for_each_map_elem callback: emit one message per tgid with accumulated
+// deltas, then zero this CPU's accumulator in place
+static long flush_tgid_aggregate(struct bpf_map *map, const void *key, void *value, void *data)
+{
+    const __u32 *tgid = key;
+    struct tgid_aggregate *agg = value;
+    struct flush_ctx *fctx = data;
+
+    if (agg->count == 0)
+        return 0;  // Nothing accumulated on this CPU since the last flush
+
+    struct perf_measurement_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+    if (!msg) {
+        count_drop(MSG_TYPE_PERF_MEASUREMENT);
+        return 1;  // Ring buffer full, stop iterating; deltas stay accumulated
+    }
+
+    msg->header.size = sizeof(*msg);
+    fill_perf_measurement(msg, *tgid, agg->cycles_delta, agg->instructions_delta,
+                          agg->llc_misses_delta, agg->cache_references_delta,
+                          agg->time_delta_ns, fctx->timestamp, 0, 0, 0, 0);
+    bpf_ringbuf_submit(msg, 0);
+
+    __builtin_memset(agg, 0, sizeof(*agg));
+    return 0;
+}
+
+// Flush this CPU's accumulated measurements as one batch per tick
+static __always_inline void flush_tgid_aggregates(void)
+{
+    struct flush_ctx fctx = {
+        .timestamp = bpf_ktime_get_ns(),
+    };
+
+    bpf_for_each_map_elem(&tgid_aggregates, flush_tgid_aggregate, &fctx, 0);
+}
+
+// bpf_for_each_map_elem callback: emit one message per cgroup with
+// accumulated deltas, then zero this CPU's accumulator in place
+static long flush_cgroup_aggregate(struct bpf_map *map, const void *key, void *value, void *data)
+{
+    const __u64 *cgroup_id = key;
+    struct tgid_aggregate *agg = value;
+    struct flush_ctx *fctx = data;
+
+    if (agg->count == 0)
+        return 0;  // Nothing accumulated on this CPU since the last flush
+
+    struct cgroup_measurement_msg *msg = bpf_ringbuf_reserve(&events_ringbuf, sizeof(*msg), 0);
+    if (!msg) {
+        count_drop(MSG_TYPE_CGROUP_MEASUREMENT);
+        return 1;  // Ring buffer full, stop iterating; deltas stay accumulated
+    }
+
+    msg->header.size = sizeof(*msg);
+    fill_header(&msg->header, MSG_TYPE_CGROUP_MEASUREMENT, fctx->timestamp);
+    msg->cgroup_id = *cgroup_id;
+    msg->cycles_delta = agg->cycles_delta;
+    msg->instructions_delta = agg->instructions_delta;
+    msg->llc_misses_delta = agg->llc_misses_delta;
+    msg->cache_references_delta = agg->cache_references_delta;
+    msg->time_delta_ns = agg->time_delta_ns;
+    bpf_ringbuf_submit(msg, 0);
+
+    __builtin_memset(agg, 0, sizeof(*agg));
+    return 0;
+}
+
+// Flush this CPU's accumulated per-cgroup measurements as one batch per tick
+static __always_inline void flush_cgroup_aggregates(void)
+{
+    struct flush_ctx fctx = {
+        .timestamp = bpf_ktime_get_ns(),
+    };
+
+    bpf_for_each_map_elem(&cgroup_aggregates, flush_cgroup_aggregate, &fctx, 0);
 }
 
 /* HR Timer expire exit tracepoint handler */
 SEC("tracepoint/timer/hrtimer_expire_exit")
 int handle_hrtimer_expire_exit(void *ctx)
 {
+    __u64 probe_start = probe_timing_start();
     __u32 key = 0;
     
     // Check if our timer fired on this CPU
@@ -427,22 +1368,39 @@ int handle_hrtimer_expire_exit(void *ctx)
     // Check and send metadata if needed
     check_and_send_metadata(ctx, current_task);
 
-    // Collect and send performance measurements before sending timer finished message (timer event)
-    collect_and_send_perf_measurements(ctx, current_task, 0, 0);
-    
-    // Send the timer processing finished message
-    send_timer_finished_processing(ctx);
-    
+    // Collect and send performance measurements, with the tick boundary
+    // marker riding on the measurement message (timer event)
+    int tick_sent = collect_and_send_perf_measurements(ctx, current_task, 0, 0, 1);
+
+    // In aggregation mode, emit this CPU's accumulated measurements as one
+    // batch per tick, keyed by cgroup or tgid depending on configuration
+    if (aggregate_in_kernel) {
+        if (aggregate_by_cgroup)
+            flush_cgroup_aggregates();
+        else
+            flush_tgid_aggregates();
+    }
+
+    // Fall back to a standalone timer finished message when the marker could
+    // not ride on a measurement: first tick on this CPU, aggregation mode
+    // (flushed batches are not tick markers), or output failure
+    if (!tick_sent)
+        send_timer_finished_processing(ctx);
+
+    // Tell userspace when the adaptive controller changed this CPU's cadence
+    if (adaptive_tick)
+        send_tick_interval_change(ctx);
+
+
 reset_and_exit:
     // Reset the flag
     struct timer_fire_info reset_info = {};
     reset_info.state = TIMER_RESET;
     reset_info.expected_cpu = info->expected_cpu;
     bpf_map_update_elem(&timer_fired, &key, &reset_info, BPF_ANY);
-    
+
+    probe_timing_record(PROBE_TIMER_TICK, probe_start);
     return 0;
 }
 
-DEFINE_SYNC_TIMER(collect, sync_timer_callback);
-
 char LICENSE[] SEC("license") = "GPL"; 
\ No newline at end of file
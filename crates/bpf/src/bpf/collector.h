@@ -11,13 +11,18 @@ enum msg_type {
     MSG_TYPE_TIMER_FINISHED_PROCESSING = 3,
     MSG_TYPE_PERF_MEASUREMENT = 4,
     MSG_TYPE_TIMER_MIGRATION_DETECTED = 5,
+    MSG_TYPE_CGROUP_MEASUREMENT = 6,
+    MSG_TYPE_COMPACT_PERF_MEASUREMENT = 7,
+    MSG_TYPE_TICK_INTERVAL_CHANGE = 8,
 };
 
 // Sample header structure that matches the one in reader.rs
 struct sample_header {
-    __u32 size;      // Size field (filled by kernel)
+    __u32 size;      // Size field (filled by kernel for perf output, by BPF for ringbuf)
     enum msg_type type;      // Message type
     __u64 timestamp; // Timestamp of the event
+    __u32 cpu;       // CPU that produced the message
+    __u32 seq;       // Per-CPU sequence number, so userspace can detect dropped records
 };
 
 // Structure for task metadata messages
@@ -34,7 +39,8 @@ struct task_free_msg {
     __u32 pid;                   // Process ID
 };
 
-// Structure for timer finished processing messages
+// Structure for timer finished processing messages. Only sent when the tick
+// marker could not ride on a perf measurement message (see is_timer_tick).
 struct timer_finished_processing_msg {
     struct sample_header header; // Common header
     // No additional data needed, timestamp in header is sufficient
@@ -51,6 +57,52 @@ struct perf_measurement_msg {
     __u64 time_delta_ns;         // Time delta in nanoseconds
     __u32 is_context_switch;     // 1 if context switch event, 0 if timer event
     __u32 next_tgid;             // Thread group ID of the process being context switched in. Only valid when is_context_switch == 1
+    __u32 is_timer_tick;         // 1 if this measurement closes a sync-timer tick, folding in the timer finished processing marker
+    __u32 sibling_tgid;          // Thread group ID running on the sibling hyperthread when the measurement was taken, 0 if none or unknown
+};
+
+// Flag bits for compact_perf_measurement_msg.flags
+#define COMPACT_MEASUREMENT_FLAG_CONTEXT_SWITCH (1 << 0)
+#define COMPACT_MEASUREMENT_FLAG_TIMER_TICK     (1 << 1)
+
+// Compact encoding of perf_measurement_msg, used when negotiated at load
+// time: deltas are 32-bit (a 1ms slice rarely exceeds a few million of
+// anything) and the boolean fields are folded into one flags word, shrinking
+// the message from 88 to 64 bytes. A measurement whose deltas do not all fit
+// in 32 bits escapes to the full format, so no precision is ever lost.
+struct compact_perf_measurement_msg {
+    struct sample_header header;  // Common header
+    __u32 pid;                    // Process ID
+    __u32 next_tgid;              // As in perf_measurement_msg, valid when the context switch flag is set
+    __u32 sibling_tgid;           // As in perf_measurement_msg
+    __u32 flags;                  // COMPACT_MEASUREMENT_FLAG_* bits
+    __u32 cycles_delta;           // CPU cycles delta
+    __u32 instructions_delta;     // Instructions delta
+    __u32 llc_misses_delta;       // LLC misses delta
+    __u32 cache_references_delta; // Cache references delta
+    __u32 time_delta_ns;          // Time delta in nanoseconds
+};
+
+// Structure for per-cgroup measurement messages, emitted once per cgroup per
+// tick when cgroup-level aggregation is enabled
+struct cgroup_measurement_msg {
+    struct sample_header header; // Common header
+    __u64 cgroup_id;             // Cgroup ID (inode number in cgroup filesystem)
+    __u64 cycles_delta;          // CPU cycles delta
+    __u64 instructions_delta;    // Instructions delta
+    __u64 llc_misses_delta;      // LLC misses delta
+    __u64 cache_references_delta; // Cache references delta
+    __u64 time_delta_ns;         // Time delta in nanoseconds
+};
+
+// Structure for tick interval change messages, emitted when the adaptive
+// tick-rate controller moves this CPU to a new interval. The header's cpu
+// and timestamp fields say which CPU changed cadence and when; ticks from
+// that CPU arrive every interval_ns from then on (still aligned to
+// base-interval boundaries, so timeslot assembly is unaffected).
+struct tick_interval_msg {
+    struct sample_header header; // Common header
+    __u64 interval_ns;           // The CPU's tick interval from this point on
 };
 
 // Structure for timer migration detection messages
@@ -3,6 +3,23 @@
 #define NSEC_PER_MSEC 1000000ULL
 #define CLOCK_MONOTONIC 1
 
+/* Tick cadence, set by the loader before load. sync_timer_interval_ns is
+ * the tick interval; sync_timer_phase_stagger_ns offsets CPU n's expiration
+ * by (n * stagger) % interval past the boundary, spreading the per-tick
+ * measurement burst across the interval instead of firing every CPU in the
+ * same microsecond. Userspace timeslot assembly subtracts the same offsets
+ * when mapping timestamps to slots. */
+const volatile __u64 sync_timer_interval_ns = NSEC_PER_MSEC;
+const volatile __u64 sync_timer_phase_stagger_ns = 0;
+
+/* This CPU's phase offset within the interval */
+static __always_inline __u64 __sync_timer_phase_offset(void) {
+    if (!sync_timer_phase_stagger_ns)
+        return 0;
+    return ((__u64)bpf_get_smp_processor_id() * sync_timer_phase_stagger_ns)
+           % sync_timer_interval_ns;
+}
+
 /* Define AF_INET constant for BPF context */
 #define AF_INET 2
 
@@ -44,6 +61,44 @@ static __always_inline __u64 __sync_timer_abs_diff(__u64 a, __u64 b) {
     return a > b ? a - b : b - a;
 }
 
+/* Number of log2 buckets in the jitter histogram: bucket 0 counts zero
+ * error, bucket i counts errors in [2^(i-1), 2^i) nanoseconds */
+#define SYNC_TIMER_JITTER_BUCKETS 64
+
+/* Branchless log2 for the histogram bucket index */
+static __always_inline __u32 __sync_timer_log2(__u64 v) {
+    __u32 r = 0;
+    if (v >> 32) { v >>= 32; r += 32; }
+    if (v >> 16) { v >>= 16; r += 16; }
+    if (v >> 8)  { v >>= 8;  r += 8; }
+    if (v >> 4)  { v >>= 4;  r += 4; }
+    if (v >> 2)  { v >>= 2;  r += 2; }
+    if (v >> 1)  {           r += 1; }
+    return r;
+}
+
+/* Record one fire-time error sample and any CPU migration */
+static __always_inline void __sync_timer_record_fire(
+    struct sync_timer_state *state,
+    __u64 error_ns,
+    void *jitter_map,
+    void *migrations_map
+) {
+    __u32 bucket = error_ns ? __sync_timer_log2(error_ns) + 1 : 0;
+    if (bucket >= SYNC_TIMER_JITTER_BUCKETS)
+        bucket = SYNC_TIMER_JITTER_BUCKETS - 1;
+    __u64 *count = bpf_map_lookup_elem(jitter_map, &bucket);
+    if (count)
+        *count += 1;
+
+    if (bpf_get_smp_processor_id() != state->expected_cpu) {
+        __u32 zero = 0;
+        __u64 *migrations = bpf_map_lookup_elem(migrations_map, &zero);
+        if (migrations)
+            *migrations += 1;
+    }
+}
+
 /* Helper function to align time to next interval */
 static __always_inline __u64 __sync_timer_align_to_interval(__u64 time, __u64 interval) {
     return (time / interval) * interval;
@@ -66,20 +121,29 @@ static __always_inline __u64 __sync_timer_compute_start_param(__u64 next_expecte
     }
 }
 
-/* Shared timer callback implementation */
+/* Shared timer callback implementation. The callback function returns the
+ * number of base intervals to sleep before the next tick (1 = normal
+ * cadence); a tickless consumer returns larger values on idle CPUs. The
+ * next expiry stays aligned to interval boundaries either way, so CPUs
+ * remain synchronized when they wake. */
 static __always_inline int __sync_timer_shared_callback(
     void *map,
     int *key,
     struct sync_timer_state *state,
-    void (*callback_func)(__u32)  // Modified to pass expected CPU ID
+    __u64 (*callback_func)(__u32),  // Receives expected CPU ID
+    void *jitter_map,
+    void *migrations_map
 ) {
     __u64 now = bpf_ktime_get_ns();
-    __u64 expected_tick = now / NSEC_PER_MSEC;
+    __u64 offset = __sync_timer_phase_offset();
+    __u64 expected_tick = (now - offset) / sync_timer_interval_ns;
     __u64 actual_tick = state->last_tick + 1;
     __u64 delta;
 
     /* Call the provided callback function with expected CPU ID */
-    callback_func(state->expected_cpu);
+    __u64 interval_mult = callback_func(state->expected_cpu);
+    if (interval_mult < 1)
+        interval_mult = 1;
 
     /* Check for missed ticks */
     if (expected_tick > actual_tick) {
@@ -90,10 +154,15 @@ static __always_inline int __sync_timer_shared_callback(
     state->last_tick = actual_tick;
 
     /* Calculate timing delta */
-    delta = __sync_timer_abs_diff(now, actual_tick * NSEC_PER_MSEC);
+    delta = __sync_timer_abs_diff(now, actual_tick * sync_timer_interval_ns + offset);
 
-    /* Calculate next absolute time for timer */
-    state->next_expected = __sync_timer_align_to_interval(now + NSEC_PER_MSEC, NSEC_PER_MSEC);
+    /* Record fire-time error and migrations for jitter diagnostics */
+    __sync_timer_record_fire(state, delta, jitter_map, migrations_map);
+
+    /* Calculate next absolute time for timer: the next interval boundary
+     * after now, shifted by this CPU's phase offset */
+    state->next_expected = __sync_timer_align_to_interval(
+        now - offset + interval_mult * sync_timer_interval_ns, sync_timer_interval_ns) + offset;
 
     /* Reschedule timer using computed start parameter */
     __u64 start_param = __sync_timer_compute_start_param(state->next_expected, state->timer_flags);
@@ -128,37 +197,30 @@ static __always_inline int __sync_timer_shared_init(
             break;
     }
 
-    /* Check if timer state already exists for this CPU and remove it to start fresh */
-    state = bpf_map_lookup_elem(timer_states_map, &cpu);
-    if (state) {
-        /* Cancel any existing timer before removing the state */
-        bpf_timer_cancel(&state->timer);
-        /* Remove existing state to ensure fresh initialization */
-        bpf_map_delete_elem(timer_states_map, &cpu);
-    }
-
-    /* Create fresh timer state for this CPU */
-    struct sync_timer_state new_state = {};
-    new_state.expected_cpu = cpu;  // Store the CPU this timer should fire on
-    new_state.timer_flags = timer_flags;
-    new_state.init_mode = init_mode;
-    ret = bpf_map_update_elem(timer_states_map, &cpu, &new_state, BPF_ANY);
-    if (ret < 0) {
-        return SYNC_TIMER_MAP_UPDATE_FAILED;
-    }
-    
-    /* Get the newly created state */
+    /* Timer state lives in an array indexed by CPU id, with entries
+     * preallocated by the kernel, so reset this CPU's slot in place. A
+     * timer object from a previous initialization attempt stays valid, so
+     * cancel it and re-arm with the new flags instead of the delete/insert
+     * cycle the old hash map needed. */
     state = bpf_map_lookup_elem(timer_states_map, &cpu);
     if (!state) {
         return SYNC_TIMER_MAP_LOOKUP_FAILED;
     }
 
+    bpf_timer_cancel(&state->timer);
+    state->last_tick = 0;
+    state->expected_cpu = cpu;  // Store the CPU this timer should fire on
+    state->timer_flags = timer_flags;
+    state->init_mode = init_mode;
+
     /* Initialize timer */
     now = bpf_ktime_get_ns();
-    state->next_expected = __sync_timer_align_to_interval(now + NSEC_PER_MSEC, NSEC_PER_MSEC);
-    
+    __u64 offset = __sync_timer_phase_offset();
+    state->next_expected = __sync_timer_align_to_interval(
+        now - offset + sync_timer_interval_ns, sync_timer_interval_ns) + offset;
+
     ret = bpf_timer_init(&state->timer, timer_states_map, CLOCK_MONOTONIC);
-    if (ret < 0) {
+    if (ret < 0 && ret != -16 /* -EBUSY: initialized on a previous attempt */) {
         return SYNC_TIMER_TIMER_INIT_FAILED;
     }
     
@@ -180,18 +242,38 @@ static __always_inline int __sync_timer_shared_init(
 /* Macro to define a complete sync timer implementation */
 #define DEFINE_SYNC_TIMER(timer_name, callback_func) \
 \
-/* Timer state map */ \
+/* Timer state map: an array indexed by CPU id, so the per-tick callback \
+ * does a direct index instead of a hash walk. The loader resizes it to \
+ * the number of possible CPUs before load. */ \
 struct { \
-    __uint(type, BPF_MAP_TYPE_HASH); \
-    __uint(max_entries, 1024); \
+    __uint(type, BPF_MAP_TYPE_ARRAY); \
+    __uint(max_entries, 1); \
     __type(key, __u32); \
     __type(value, struct sync_timer_state); \
 } sync_timer_states_##timer_name SEC(".maps"); \
 \
+/* Per-CPU log2 histogram of fire-time error versus the expected boundary */ \
+struct { \
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY); \
+    __uint(max_entries, SYNC_TIMER_JITTER_BUCKETS); \
+    __type(key, __u32); \
+    __type(value, __u64); \
+} sync_timer_jitter_##timer_name SEC(".maps"); \
+\
+/* Per-CPU count of fires observed on the wrong CPU */ \
+struct { \
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY); \
+    __uint(max_entries, 1); \
+    __type(key, __u32); \
+    __type(value, __u64); \
+} sync_timer_migrations_##timer_name SEC(".maps"); \
+\
 /* Timer callback function */ \
 static int sync_timer_callback_##timer_name(void *map, int *key, struct sync_timer_state *state) \
 { \
-    return __sync_timer_shared_callback(map, key, state, callback_func); \
+    return __sync_timer_shared_callback(map, key, state, callback_func, \
+                                        &sync_timer_jitter_##timer_name, \
+                                        &sync_timer_migrations_##timer_name); \
 } \
 \
 /* Unified timer initialization function with mode parameter */ \
@@ -1,8 +1,10 @@
 use anyhow::{anyhow, Context, Result};
 use libbpf_rs::skel::{OpenSkel, Skel, SkelBuilder};
-use libbpf_rs::{set_print, OpenObject, PrintLevel};
-use perf_events::{Dispatcher, HardwareCounter, PerfMapReader};
+use libbpf_rs::{set_print, MapHandle, OpenObject, PrintLevel, RingBuffer, RingBufferBuilder};
+use perf_events::{Dispatcher, HardwareCounter, PerfMapReader, SampleHeader};
+use std::cell::{Ref, RefCell, RefMut};
 use std::mem::MaybeUninit;
+use std::rc::Rc;
 use std::time::Duration;
 
 pub mod sync_timer;
@@ -19,8 +21,10 @@ mod test_bpf {
 
 // Re-export the specific types we need
 pub use bpf::types::{
-    msg_type, perf_measurement_msg as PerfMeasurementMsg, sync_timer_mode,
-    task_free_msg as TaskFreeMsg, task_metadata_msg as TaskMetadataMsg,
+    cgroup_measurement_msg as CgroupMeasurementMsg,
+    compact_perf_measurement_msg as CompactPerfMeasurementMsg, msg_type,
+    perf_measurement_msg as PerfMeasurementMsg, sync_timer_mode, task_free_msg as TaskFreeMsg,
+    task_metadata_msg as TaskMetadataMsg, tick_interval_msg as TickIntervalMsg,
     timer_finished_processing_msg as TimerFinishedProcessingMsg,
     timer_migration_msg as TimerMigrationMsg,
 };
@@ -31,20 +35,150 @@ unsafe impl plain::Plain for TaskFreeMsg {}
 unsafe impl plain::Plain for TimerFinishedProcessingMsg {}
 unsafe impl plain::Plain for PerfMeasurementMsg {}
 unsafe impl plain::Plain for TimerMigrationMsg {}
+unsafe impl plain::Plain for CgroupMeasurementMsg {}
+unsafe impl plain::Plain for CompactPerfMeasurementMsg {}
+unsafe impl plain::Plain for TickIntervalMsg {}
+
+/// Flag bits in `CompactPerfMeasurementMsg::flags`, matching the
+/// COMPACT_MEASUREMENT_FLAG_* defines in collector.h
+pub mod compact_measurement_flags {
+    pub const CONTEXT_SWITCH: u32 = 1 << 0;
+    pub const TIMER_TICK: u32 = 1 << 1;
+}
+
+impl From<&CompactPerfMeasurementMsg> for PerfMeasurementMsg {
+    /// Widen a compact measurement back to the full wire format, so consumers
+    /// can share one decode path regardless of the negotiated encoding
+    fn from(compact: &CompactPerfMeasurementMsg) -> Self {
+        let mut msg = PerfMeasurementMsg::default();
+        msg.header = compact.header;
+        msg.pid = compact.pid;
+        msg.cycles_delta = compact.cycles_delta as u64;
+        msg.instructions_delta = compact.instructions_delta as u64;
+        msg.llc_misses_delta = compact.llc_misses_delta as u64;
+        msg.cache_references_delta = compact.cache_references_delta as u64;
+        msg.time_delta_ns = compact.time_delta_ns as u64;
+        msg.is_context_switch =
+            (compact.flags & compact_measurement_flags::CONTEXT_SWITCH != 0) as u32;
+        msg.next_tgid = compact.next_tgid;
+        msg.is_timer_tick = (compact.flags & compact_measurement_flags::TIMER_TICK != 0) as u32;
+        msg.sibling_tgid = compact.sibling_tgid;
+        msg
+    }
+}
 
 // Re-export important sync timer types
 pub use sync_timer::SyncTimerError;
 
+/// Transport used to deliver BPF event messages to userspace
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum EventsTransport {
+    /// Per-CPU perf event array, k-way merged by timestamp in userspace
+    #[default]
+    PerfArray,
+    /// Shared BPF ring buffer, with messages built in place via reserve/commit
+    RingBuf,
+}
+
+/// Which hardware counters to collect on each measurement
+///
+/// Disabled counters are never opened, freeing their PMU slots, and the
+/// corresponding reads are dead-code-eliminated from the BPF program at load.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EnabledCounters {
+    pub cycles: bool,
+    pub instructions: bool,
+    pub llc_misses: bool,
+    pub cache_references: bool,
+}
+
+impl Default for EnabledCounters {
+    fn default() -> Self {
+        Self {
+            cycles: true,
+            instructions: true,
+            llc_misses: true,
+            cache_references: true,
+        }
+    }
+}
+
+/// Load-time configuration for the BPF collector
+#[derive(Debug, Clone, Default)]
+pub struct LoaderConfig {
+    /// Transport used to deliver event messages to userspace
+    pub transport: EventsTransport,
+    /// Aggregate per-tgid measurements in kernel and flush once per tick.
+    /// Requires the ring buffer transport.
+    pub in_kernel_aggregation: bool,
+    /// Roll the in-kernel aggregation up to the cgroup level: key the
+    /// aggregation map by cgroup ID instead of tgid, collapsing all of a
+    /// container's processes into one record per tick. Requires
+    /// `in_kernel_aggregation`.
+    pub cgroup_aggregation: bool,
+    /// Emit measurements in the compact 32-bit-delta encoding, shrinking each
+    /// message from 88 to 64 bytes. Measurements whose deltas overflow 32
+    /// bits automatically escape to the full format.
+    pub compact_measurements: bool,
+    /// Hardware counters to collect
+    pub counters: EnabledCounters,
+    /// Suppress context-switch measurements for slices shorter than this
+    /// many nanoseconds, folding them into the same tgid's next measurement.
+    /// Zero disables suppression.
+    pub min_slice_ns: u64,
+    /// Let the sync timer stretch its interval on idle CPUs (up to 64ms)
+    /// instead of firing every 1ms; sched_switch snaps it back to 1ms
+    pub tickless_idle: bool,
+    /// Adapt each CPU's tick interval to its recent load: busy, healthy CPUs
+    /// run at `timer_interval_ns` (the floor), quiet CPUs back off one
+    /// doubling per tick, and CPUs whose outputs are dropping back off to
+    /// shed the collector's own overhead. Interval changes are reported in
+    /// the output stream. Supersedes `tickless_idle`.
+    pub adaptive_tick: bool,
+    /// Interval ceiling for the adaptive controller, in power-of-two
+    /// multiples of the floor: ceiling = floor << shift. Zero keeps the BPF
+    /// default (16x the floor).
+    pub adaptive_max_shift: u32,
+    /// Context switches per tick at or above which the adaptive controller
+    /// keeps a CPU at the floor interval. Zero keeps the BPF default (8).
+    pub adaptive_busy_switches: u32,
+    /// Sync timer tick interval in nanoseconds (also the timeslot size)
+    pub timer_interval_ns: u64,
+    /// Per-CPU tick phase offset step in nanoseconds. CPU n fires
+    /// (n * stagger) % interval past each boundary, spreading the per-tick
+    /// measurement burst across the interval. Zero fires all CPUs together.
+    pub timer_phase_stagger_ns: u64,
+    /// Per-CPU perf buffer size in pages (power of two). Zero sizes the
+    /// buffers automatically from the CPU count, keeping the total mapped
+    /// memory bounded on large machines.
+    pub perf_buffer_pages: u32,
+    /// Bytes buffered per CPU before the kernel wakes the reader. `None`
+    /// uses a quarter of the per-CPU buffer so each wakeup processes a
+    /// batch; `Some(0)` wakes on every event.
+    pub perf_wakeup_watermark_bytes: Option<u32>,
+    /// Time a sampled subset of BPF handler executions and accumulate
+    /// per-probe log2 duration histograms in kernel
+    pub probe_timing: bool,
+    /// Sample one in 2^shift handler executions when probe timing is on
+    pub probe_timing_sample_shift: u32,
+}
+
+/// The active consumer for the events output
+enum EventsReader {
+    Perf(PerfMapReader),
+    RingBuf(RingBuffer<'static>),
+}
+
 /// The BPF dispatcher to manage BPF program lifecycle
 pub struct BpfLoader {
     skel: bpf::CollectorSkel<'static>,
-    dispatcher: Dispatcher,
-    perf_map_reader: PerfMapReader,
+    dispatcher: Rc<RefCell<Dispatcher>>,
+    events_reader: EventsReader,
 }
 
 impl BpfLoader {
     /// Create a new BPF loader with initialized skeleton
-    pub fn new() -> Result<Self> {
+    pub fn new(config: LoaderConfig) -> Result<Self> {
         fn print_to_log(level: PrintLevel, msg: String) {
             match level {
                 PrintLevel::Debug => log::debug!("{}", msg),
@@ -55,15 +189,31 @@ impl BpfLoader {
 
         set_print(Some((PrintLevel::Debug, print_to_log)));
 
+        if config.in_kernel_aggregation && config.transport != EventsTransport::RingBuf {
+            return Err(anyhow!(
+                "In-kernel aggregation requires the ring buffer transport"
+            ));
+        }
+        if config.cgroup_aggregation && !config.in_kernel_aggregation {
+            return Err(anyhow!(
+                "Cgroup-level aggregation requires in-kernel aggregation"
+            ));
+        }
+        if config.adaptive_tick && config.tickless_idle {
+            return Err(anyhow!(
+                "The adaptive tick rate already stretches idle CPUs; drop tickless_idle"
+            ));
+        }
+
         // Load BPF program (non-verbose, use the log crate to print errors)
-        let skel_result = Self::load_skel(false);
+        let skel_result = Self::load_skel(false, &config);
 
         if let Err(e) = skel_result {
             log::error!("Failed to load BPF program: {}", e);
             log::error!("Reloading with debug flag, for more information");
 
             // Reload with debug flag (verbose, to always print the error to stderr)
-            let _ = Self::load_skel(true);
+            let _ = Self::load_skel(true, &config);
 
             // Return the original error
             return Err(e);
@@ -71,51 +221,107 @@ impl BpfLoader {
 
         let mut skel = skel_result.expect("checked above that it's not an error");
 
-        // Initialize perf event rings for the hardware counters
-        if let Err(e) =
-            perf_events::open_perf_counter(&mut skel.maps.cycles, HardwareCounter::Cycles)
-        {
-            return Err(anyhow!("Failed to open cycles counter: {:?}", e));
+        // Initialize perf events for the enabled hardware counters as one
+        // group per CPU (first counter as leader) so the PMU schedules them
+        // together and the deltas read on the BPF side are mutually consistent
+        let mut counter_group = Vec::new();
+        if config.counters.cycles {
+            counter_group.push((&mut skel.maps.cycles, HardwareCounter::Cycles));
         }
-
-        if let Err(e) = perf_events::open_perf_counter(
-            &mut skel.maps.instructions,
-            HardwareCounter::Instructions,
-        ) {
-            return Err(anyhow!("Failed to open instructions counter: {:?}", e));
+        if config.counters.instructions {
+            counter_group.push((&mut skel.maps.instructions, HardwareCounter::Instructions));
         }
-
-        if let Err(e) =
-            perf_events::open_perf_counter(&mut skel.maps.llc_misses, HardwareCounter::LLCMisses)
-        {
-            return Err(anyhow!("Failed to open LLC misses counter: {:?}", e));
+        if config.counters.llc_misses {
+            counter_group.push((&mut skel.maps.llc_misses, HardwareCounter::LLCMisses));
         }
-
-        if let Err(e) = perf_events::open_perf_counter(
-            &mut skel.maps.cache_references,
-            HardwareCounter::CacheReferences,
-        ) {
-            return Err(anyhow!("Failed to open cache references counter: {:?}", e));
+        if config.counters.cache_references {
+            counter_group.push((
+                &mut skel.maps.cache_references,
+                HardwareCounter::CacheReferences,
+            ));
         }
+        if counter_group.is_empty() {
+            return Err(anyhow!("At least one hardware counter must be enabled"));
+        }
+        if let Err(e) = perf_events::open_perf_counter_group(&mut counter_group) {
+            return Err(anyhow!("Failed to open hardware counter group: {:?}", e));
+        }
+        drop(counter_group);
 
-        // Set up the perf map reader for the events map
-        let buffer_pages = 32;
-        let watermark_bytes = 0; // Wake up on every event
-        let perf_map_reader =
-            PerfMapReader::new(&mut skel.maps.events, buffer_pages, watermark_bytes)
-                .map_err(|e| anyhow!("Failed to create PerfMapReader: {}", e))?;
+        // Fill in the sibling hyperthread topology so measurements can
+        // attribute the co-runner on the sibling CPU
+        populate_sibling_cpus(&skel.maps.sibling_cpus)
+            .with_context(|| "Failed to populate sibling CPU map")?;
 
         // Create a dispatcher to handle events
-        let dispatcher = Dispatcher::new();
+        let dispatcher = Rc::new(RefCell::new(Dispatcher::new()));
+
+        // Set up the events consumer for the selected transport
+        let events_reader = match config.transport {
+            EventsTransport::PerfArray => {
+                let buffer_pages = if config.perf_buffer_pages != 0 {
+                    config.perf_buffer_pages
+                } else {
+                    default_perf_buffer_pages()?
+                };
+                // Default the wakeup watermark to a quarter of the per-CPU
+                // buffer: late enough to batch records per epoll wake, early
+                // enough to leave headroom while userspace catches up
+                let buffer_bytes = buffer_pages as u64 * page_size::get() as u64;
+                let watermark_bytes = config
+                    .perf_wakeup_watermark_bytes
+                    .unwrap_or((buffer_bytes / 4).min(u32::MAX as u64) as u32);
+                let perf_map_reader =
+                    PerfMapReader::new(&mut skel.maps.events, buffer_pages, watermark_bytes)
+                        .map_err(|e| anyhow!("Failed to create PerfMapReader: {}", e))?;
+                EventsReader::Perf(perf_map_reader)
+            }
+            EventsTransport::RingBuf => {
+                // The ring buffer callback needs a 'static reference to the map.
+                // Clone a handle to the map and leak it, mirroring the skeleton
+                // storage leak above (once per program run).
+                let map_handle = MapHandle::try_from(&skel.maps.events_ringbuf)
+                    .map_err(|e| anyhow!("Failed to clone events_ringbuf handle: {}", e))?;
+                let map_handle: &'static MapHandle = Box::leak(Box::new(map_handle));
+
+                let dispatcher_cb = dispatcher.clone();
+                let mut builder = RingBufferBuilder::new();
+                builder
+                    .add(map_handle, move |data: &[u8]| {
+                        // Messages carry the full sample header including the
+                        // producing CPU, which stands in for the ring index
+                        // that the perf path derives from the per-CPU buffer.
+                        let header: &SampleHeader = match plain::from_bytes(data) {
+                            Ok(header) => header,
+                            Err(_) => {
+                                log::error!("Ring buffer record too small for sample header");
+                                return 0;
+                            }
+                        };
+                        if let Err(e) = dispatcher_cb
+                            .borrow_mut()
+                            .dispatch_sample(header.cpu as usize, data)
+                        {
+                            log::error!("Failed to dispatch ring buffer record: {}", e);
+                        }
+                        0
+                    })
+                    .map_err(|e| anyhow!("Failed to add events_ringbuf to ring buffer: {}", e))?;
+                let ring_buffer = builder
+                    .build()
+                    .map_err(|e| anyhow!("Failed to create ring buffer: {}", e))?;
+                EventsReader::RingBuf(ring_buffer)
+            }
+        };
 
         Ok(Self {
             skel,
             dispatcher,
-            perf_map_reader,
+            events_reader,
         })
     }
 
-    fn load_skel(verbose: bool) -> Result<bpf::CollectorSkel<'static>> {
+    fn load_skel(verbose: bool, config: &LoaderConfig) -> Result<bpf::CollectorSkel<'static>> {
         let mut skel_builder = bpf::CollectorSkelBuilder::default();
         if verbose {
             skel_builder.obj_builder.debug(true);
@@ -128,26 +334,198 @@ impl BpfLoader {
         // 3. The memory will be reclaimed when the program exits
         let obj_ref = Box::leak(Box::new(MaybeUninit::<OpenObject>::uninit()));
 
-        let open_skel = skel_builder.open(obj_ref)?;
+        let mut open_skel = skel_builder.open(obj_ref)?;
+
+        let num_cpus = libbpf_rs::num_possible_cpus()? as u32;
+
+        // Size the sync timer state array to the machine; the header only
+        // declares a single placeholder entry
+        open_skel
+            .maps
+            .sync_timer_states_collect
+            .set_max_entries(num_cpus)
+            .with_context(|| "Failed to size sync timer state array")?;
+
+        // Select the events output transport before load so the verifier
+        // eliminates the unused output path
+        if config.transport == EventsTransport::RingBuf {
+            open_skel.maps.rodata_data.use_ringbuf = 1;
+
+            // Size the shared ring buffer by CPU count (must be a power of two)
+            let ringbuf_bytes = (num_cpus * 256 * 1024).next_power_of_two();
+            open_skel
+                .maps
+                .events_ringbuf
+                .set_max_entries(ringbuf_bytes)
+                .with_context(|| "Failed to size events ring buffer")?;
+        }
+
+        // Enable in-kernel per-tgid aggregation, flushed once per tick
+        if config.in_kernel_aggregation {
+            open_skel.maps.rodata_data.aggregate_in_kernel = 1;
+        }
+
+        // Roll the aggregation up to the cgroup level
+        if config.cgroup_aggregation {
+            open_skel.maps.rodata_data.aggregate_by_cgroup = 1;
+        }
+
+        // Emit measurements in the compact encoding
+        if config.compact_measurements {
+            open_skel.maps.rodata_data.compact_measurements = 1;
+        }
+
+        // Specialize the enabled counter set so the verifier eliminates the
+        // reads of disabled counters
+        let rodata = &mut open_skel.maps.rodata_data;
+        rodata.counter_cycles_enabled = config.counters.cycles as u32;
+        rodata.counter_instructions_enabled = config.counters.instructions as u32;
+        rodata.counter_llc_misses_enabled = config.counters.llc_misses as u32;
+        rodata.counter_cache_references_enabled = config.counters.cache_references as u32;
+
+        // Hold back context-switch slices shorter than the threshold
+        rodata.min_slice_ns = config.min_slice_ns;
+
+        // Stretch the sync timer interval on idle CPUs
+        rodata.tickless_idle = config.tickless_idle as u32;
+
+        // Adaptive per-CPU tick-rate controller (zero values keep the
+        // defaults baked into the BPF program)
+        rodata.adaptive_tick = config.adaptive_tick as u32;
+        if config.adaptive_max_shift != 0 {
+            // Cap the ceiling at 2^10 = 1024x the floor interval
+            rodata.adaptive_max_shift = config.adaptive_max_shift.min(10);
+        }
+        if config.adaptive_busy_switches != 0 {
+            rodata.adaptive_busy_switches = config.adaptive_busy_switches;
+        }
+
+        // Tick cadence and per-CPU phase stagger (zero interval keeps the
+        // 1ms default baked into the BPF program)
+        if config.timer_interval_ns != 0 {
+            rodata.sync_timer_interval_ns = config.timer_interval_ns;
+        }
+        rodata.sync_timer_phase_stagger_ns = config.timer_phase_stagger_ns;
+
+        // Probe self-timing instrumentation
+        rodata.probe_timing_enabled = config.probe_timing as u32;
+        rodata.probe_timing_sample_shift = config.probe_timing_sample_shift;
+
         open_skel
             .load()
             .with_context(|| "Failed to load BPF program")
     }
 
     /// Get a reference to the perf events dispatcher
-    pub fn dispatcher(&self) -> &Dispatcher {
-        &self.dispatcher
+    pub fn dispatcher(&self) -> Ref<'_, Dispatcher> {
+        self.dispatcher.borrow()
     }
 
     /// Get a mutable reference to the perf events dispatcher
-    pub fn dispatcher_mut(&mut self) -> &mut Dispatcher {
-        &mut self.dispatcher
+    pub fn dispatcher_mut(&mut self) -> RefMut<'_, Dispatcher> {
+        self.dispatcher.borrow_mut()
     }
 
     /// Initialize and start the sync timer
     pub fn start_sync_timer(&mut self) -> Result<()> {
-        sync_timer::initialize_sync_timer(&self.skel.progs.sync_timer_init_collect)
-            .map_err(|e| anyhow::anyhow!("Sync timer initialization failed: {}", e))
+        use bpf::types::sync_timer_mode;
+
+        // Probe window: long enough for ~100 ticks at the default 1ms
+        // interval, short enough not to delay startup noticeably
+        const PROBE_WINDOW: Duration = Duration::from_millis(100);
+
+        // Try each mode in order of preference. Initialization succeeding is
+        // not enough: a mode can load cleanly and still migrate off its CPU
+        // or fire with poor jitter (e.g. absolute-time modes with timer
+        // migration enabled), so briefly observe the timer's own jitter
+        // histogram and migration counter and move on when fires land on the
+        // wrong CPU. If no mode is clean, keep the one with the fewest
+        // migrations.
+        let mut best: Option<(sync_timer_mode, u64)> = None;
+        for mode in sync_timer_mode::FALLBACK_ORDER {
+            if let Err(e) = sync_timer::initialize_timers_with_mode(
+                &self.skel.progs.sync_timer_init_collect,
+                mode,
+            ) {
+                log::warn!(
+                    "Sync timer initialization failed with {}: {}",
+                    mode.description(),
+                    e
+                );
+                continue;
+            }
+
+            let before = self.sync_timer_stats()?;
+            std::thread::sleep(PROBE_WINDOW);
+            let probe = self.sync_timer_stats()?.since(&before);
+
+            log::info!(
+                "Sync timer probe with {}: {} fires, {} migrations, jitter p50/p99/p999 = {:?}/{:?}/{:?} ns",
+                mode.description(),
+                probe.samples(),
+                probe.migrations,
+                probe.jitter_percentile(0.50),
+                probe.jitter_percentile(0.99),
+                probe.jitter_percentile(0.999),
+            );
+
+            if probe.samples() > 0 && probe.migrations == 0 {
+                log::info!("Selected sync timer mode: {}", mode.description());
+                return Ok(());
+            }
+
+            if best.map_or(true, |(_, migrations)| probe.migrations < migrations) {
+                best = Some((mode, probe.migrations));
+            }
+        }
+
+        // No mode was migration-free; fall back to the least bad one
+        let (mode, migrations) =
+            best.ok_or_else(|| anyhow!("Sync timer initialization failed in all modes"))?;
+        log::warn!(
+            "No migration-free sync timer mode found; using {} ({} migrations during probe)",
+            mode.description(),
+            migrations
+        );
+        sync_timer::initialize_timers_with_mode(&self.skel.progs.sync_timer_init_collect, mode)
+            .map_err(|e| anyhow!("Sync timer initialization failed: {}", e))
+    }
+
+    /// Read the sync timer's jitter histogram and migration counter,
+    /// summed across CPUs
+    pub fn sync_timer_stats(&self) -> Result<sync_timer::SyncTimerStats> {
+        use libbpf_rs::MapCore as _;
+
+        let mut stats = sync_timer::SyncTimerStats {
+            jitter_histogram: vec![0u64; sync_timer::JITTER_HISTOGRAM_BUCKETS],
+            migrations: 0,
+        };
+
+        let jitter_map = &self.skel.maps.sync_timer_jitter_collect;
+        for (bucket, count) in stats.jitter_histogram.iter_mut().enumerate() {
+            let key = (bucket as u32).to_le_bytes();
+            if let Some(per_cpu) = jitter_map.lookup_percpu(&key, libbpf_rs::MapFlags::ANY)? {
+                for value in per_cpu {
+                    let bytes: [u8; 8] = value[..8]
+                        .try_into()
+                        .map_err(|_| anyhow!("Unexpected jitter histogram value size"))?;
+                    *count += u64::from_le_bytes(bytes);
+                }
+            }
+        }
+
+        let migrations_map = &self.skel.maps.sync_timer_migrations_collect;
+        let key = 0u32.to_le_bytes();
+        if let Some(per_cpu) = migrations_map.lookup_percpu(&key, libbpf_rs::MapFlags::ANY)? {
+            for value in per_cpu {
+                let bytes: [u8; 8] = value[..8]
+                    .try_into()
+                    .map_err(|_| anyhow!("Unexpected migration counter value size"))?;
+                stats.migrations += u64::from_le_bytes(bytes);
+            }
+        }
+
+        Ok(stats)
     }
 
     /// Attach BPF programs
@@ -158,28 +536,110 @@ impl BpfLoader {
         Ok(())
     }
 
-    /// Poll the ring buffer for events
+    /// Poll the events output for new messages
     pub fn poll_events(&mut self, timeout_ms: u64) -> Result<()> {
-        // Get the reader from the map reader
-        let reader_mut = self.perf_map_reader.reader_mut();
+        match &mut self.events_reader {
+            EventsReader::Perf(perf_map_reader) => {
+                // Block until the kernel signals a buffer has reached its
+                // wakeup watermark (or the timeout elapses, bounding the
+                // latency of records below the watermark), then sweep all
+                // rings once so each wakeup processes a batch of records
+                perf_map_reader.wait(timeout_ms as i32)?;
 
-        // Start a read batch
-        reader_mut.start()?;
+                // Get the reader from the map reader
+                let reader_mut = perf_map_reader.reader_mut();
 
-        // Dispatch all available events
-        self.dispatcher.dispatch_all(reader_mut)?;
+                // Start a read batch
+                reader_mut.start()?;
 
-        // Finish the read batch
-        reader_mut.finish()?;
+                // Dispatch all available events
+                self.dispatcher.borrow_mut().dispatch_all(reader_mut)?;
 
-        // Short sleep to avoid busy-waiting if requested
-        if timeout_ms > 0 {
-            std::thread::sleep(Duration::from_millis(timeout_ms));
+                // Finish the read batch
+                reader_mut.finish()?;
+            }
+            EventsReader::RingBuf(ring_buffer) => {
+                // Blocks until records are available or the timeout elapses,
+                // dispatching through the ring buffer callback
+                ring_buffer.poll(Duration::from_millis(timeout_ms))?;
+            }
         }
 
         Ok(())
     }
 
+    /// Read the in-kernel drop counters, summed across CPUs and indexed by
+    /// msg_type value. These count messages the BPF side failed to output
+    /// (perf buffer full or ring buffer reservation failure).
+    pub fn drop_counts(&self) -> Result<Vec<u64>> {
+        use libbpf_rs::MapCore as _;
+
+        let map = &self.skel.maps.drop_counters;
+        let num_types = map.info()?.info.max_entries as usize;
+        let mut counts = vec![0u64; num_types];
+
+        for (msg_type, count) in counts.iter_mut().enumerate() {
+            let key = (msg_type as u32).to_le_bytes();
+            if let Some(per_cpu) = map.lookup_percpu(&key, libbpf_rs::MapFlags::ANY)? {
+                for value in per_cpu {
+                    let bytes: [u8; 8] = value[..8]
+                        .try_into()
+                        .map_err(|_| anyhow!("Unexpected drop counter value size"))?;
+                    *count += u64::from_le_bytes(bytes);
+                }
+            }
+        }
+
+        Ok(counts)
+    }
+
+    /// Read the per-probe duration histograms accumulated by the BPF
+    /// handlers' self-timing, summed across CPUs. Returns one entry per
+    /// instrumented probe: (probe name, log2 bucket counts, total sampled
+    /// nanoseconds). Bucket 0 counts zero-duration samples; bucket i counts
+    /// durations in [2^(i-1), 2^i) nanoseconds.
+    pub fn probe_duration_stats(&self) -> Result<Vec<(&'static str, Vec<u64>, u64)>> {
+        use libbpf_rs::MapCore as _;
+
+        // Mirrors enum probe_id and PROBE_DURATION_BUCKETS in collector.bpf.c
+        const PROBE_NAMES: [&str; 2] = ["sched_switch", "timer_tick"];
+        const BUCKETS: usize = 64;
+
+        let hist_map = &self.skel.maps.probe_duration_hist;
+        let sum_map = &self.skel.maps.probe_duration_sum;
+        let mut stats = Vec::with_capacity(PROBE_NAMES.len());
+
+        for (probe, name) in PROBE_NAMES.iter().enumerate() {
+            let mut buckets = vec![0u64; BUCKETS];
+            for (bucket, count) in buckets.iter_mut().enumerate() {
+                let key = ((probe * BUCKETS + bucket) as u32).to_le_bytes();
+                if let Some(per_cpu) = hist_map.lookup_percpu(&key, libbpf_rs::MapFlags::ANY)? {
+                    for value in per_cpu {
+                        let bytes: [u8; 8] = value[..8]
+                            .try_into()
+                            .map_err(|_| anyhow!("Unexpected histogram value size"))?;
+                        *count += u64::from_le_bytes(bytes);
+                    }
+                }
+            }
+
+            let mut sum = 0u64;
+            let key = (probe as u32).to_le_bytes();
+            if let Some(per_cpu) = sum_map.lookup_percpu(&key, libbpf_rs::MapFlags::ANY)? {
+                for value in per_cpu {
+                    let bytes: [u8; 8] = value[..8]
+                        .try_into()
+                        .map_err(|_| anyhow!("Unexpected histogram sum size"))?;
+                    sum += u64::from_le_bytes(bytes);
+                }
+            }
+
+            stats.push((*name, buckets, sum));
+        }
+
+        Ok(stats)
+    }
+
     /// Get a reference to the BPF skeleton
     pub fn skel(&self) -> &bpf::CollectorSkel<'static> {
         &self.skel
@@ -190,3 +650,68 @@ impl BpfLoader {
         &mut self.skel
     }
 }
+
+/// Default per-CPU perf buffer size in pages: 64 pages per CPU up to 32
+/// CPUs, halved each time the CPU count doubles past that, so the total
+/// mapped memory stays bounded (~8 MiB of data pages with 4 KiB pages) on
+/// large machines. Always a power of two, as the perf mmap layout requires,
+/// with an 8-page floor so bursts still batch on very large machines.
+fn default_perf_buffer_pages() -> Result<u32> {
+    let num_cpus = libbpf_rs::num_possible_cpus()? as u32;
+
+    let mut pages = 64u32;
+    let mut cpus = 32u32;
+    while num_cpus > cpus && pages > 8 {
+        pages /= 2;
+        cpus *= 2;
+    }
+
+    Ok(pages)
+}
+
+/// Fill the sibling_cpus map from sysfs CPU topology. CPUs without a sibling
+/// hyperthread (SMT disabled) are marked with u32::MAX so the BPF side skips
+/// the lookup.
+fn populate_sibling_cpus(map: &impl libbpf_rs::MapCore) -> Result<()> {
+    let num_cpus = libbpf_rs::num_possible_cpus()?;
+
+    for cpu in 0..num_cpus {
+        let sibling = sibling_of(cpu).unwrap_or(u32::MAX);
+
+        let key = (cpu as u32).to_le_bytes();
+        let value = sibling.to_le_bytes();
+        map.update(&key, &value, libbpf_rs::MapFlags::ANY)
+            .with_context(|| format!("Failed to set sibling for CPU {}", cpu))?;
+    }
+
+    Ok(())
+}
+
+/// Parse the sibling hyperthread of `cpu` from its thread_siblings_list,
+/// which holds entries like "0,32" or "0-1"
+fn sibling_of(cpu: usize) -> Option<u32> {
+    let path = format!(
+        "/sys/devices/system/cpu/cpu{}/topology/thread_siblings_list",
+        cpu
+    );
+    let list = std::fs::read_to_string(path).ok()?;
+
+    for token in list.trim().split(',') {
+        if let Some((start, end)) = token.split_once('-') {
+            let start: u32 = start.parse().ok()?;
+            let end: u32 = end.parse().ok()?;
+            for id in start..=end {
+                if id as usize != cpu {
+                    return Some(id);
+                }
+            }
+        } else {
+            let id: u32 = token.parse().ok()?;
+            if id as usize != cpu {
+                return Some(id);
+            }
+        }
+    }
+
+    None
+}
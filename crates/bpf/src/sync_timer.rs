@@ -10,7 +10,14 @@ use thiserror::Error;
 use crate::bpf::types::{sync_timer_init_error, sync_timer_mode};
 
 impl sync_timer_mode {
-    fn description(&self) -> &'static str {
+    /// Initialization modes in order of preference
+    pub const FALLBACK_ORDER: [sync_timer_mode; 3] = [
+        sync_timer_mode::SYNC_TIMER_MODE_MODERN,
+        sync_timer_mode::SYNC_TIMER_MODE_INTERMEDIATE,
+        sync_timer_mode::SYNC_TIMER_MODE_LEGACY,
+    ];
+
+    pub fn description(&self) -> &'static str {
         match self {
             sync_timer_mode::SYNC_TIMER_MODE_MODERN => {
                 "modern CPU pinning + absolute time (kernel 6.7+)"
@@ -100,6 +107,64 @@ pub enum SyncTimerError {
 
 const TIMER_MIGRATION_SYSCTL_PATH: &str = "/proc/sys/kernel/timer_migration";
 
+/// Number of log2 buckets in the BPF jitter histogram. Bucket 0 counts
+/// zero-error fires; bucket `i` counts fire-time errors in
+/// `[2^(i-1), 2^i)` nanoseconds. Mirrors `SYNC_TIMER_JITTER_BUCKETS`.
+pub const JITTER_HISTOGRAM_BUCKETS: usize = 64;
+
+/// Timer fire statistics accumulated by the BPF sync timer callback:
+/// a log2 histogram of fire-time error versus the expected boundary, and
+/// the number of fires observed on the wrong CPU.
+#[derive(Debug, Clone, Default)]
+pub struct SyncTimerStats {
+    /// Log2 histogram of fire-time error, summed across CPUs
+    pub jitter_histogram: Vec<u64>,
+    /// Fires observed on a CPU other than the expected one
+    pub migrations: u64,
+}
+
+impl SyncTimerStats {
+    /// Total number of recorded timer fires
+    pub fn samples(&self) -> u64 {
+        self.jitter_histogram.iter().sum()
+    }
+
+    /// Estimate the given jitter percentile (0.0..=1.0) in nanoseconds.
+    ///
+    /// Returns the upper bound of the histogram bucket containing the
+    /// percentile, or `None` when no samples have been recorded.
+    pub fn jitter_percentile(&self, percentile: f64) -> Option<u64> {
+        let total = self.samples();
+        if total == 0 {
+            return None;
+        }
+        let threshold = (percentile * total as f64).ceil() as u64;
+        let mut cumulative = 0u64;
+        for (bucket, &count) in self.jitter_histogram.iter().enumerate() {
+            cumulative += count;
+            if cumulative >= threshold {
+                // Bucket 0 is exactly zero; bucket i spans [2^(i-1), 2^i)
+                return Some(if bucket == 0 { 0 } else { 1u64 << bucket });
+            }
+        }
+        Some(1u64 << (self.jitter_histogram.len() - 1))
+    }
+
+    /// Statistics accumulated since an earlier snapshot
+    pub fn since(&self, earlier: &SyncTimerStats) -> SyncTimerStats {
+        let jitter_histogram = self
+            .jitter_histogram
+            .iter()
+            .zip(earlier.jitter_histogram.iter().chain(std::iter::repeat(&0)))
+            .map(|(now, before)| now.wrapping_sub(*before))
+            .collect();
+        SyncTimerStats {
+            jitter_histogram,
+            migrations: self.migrations.wrapping_sub(earlier.migrations),
+        }
+    }
+}
+
 /// Read the current value of kernel.timer_migration sysctl
 fn read_timer_migration_sysctl() -> Result<u8, SyncTimerError> {
     let content = fs::read_to_string(TIMER_MIGRATION_SYSCTL_PATH)
@@ -141,10 +206,10 @@ fn write_timer_migration_sysctl(value: u8) -> Result<(), SyncTimerError> {
 /// # Example
 ///
 /// ```rust,no_run
-/// use bpf::{BpfLoader, sync_timer::SyncTimerError};
+/// use bpf::{BpfLoader, LoaderConfig, sync_timer::SyncTimerError};
 /// use log::{error, info};
 ///
-/// let mut loader = BpfLoader::new(false)?;
+/// let mut loader = BpfLoader::new(LoaderConfig::default())?;
 ///
 /// match loader.start_sync_timer() {
 ///     Ok(()) => info!("Sync timer initialized successfully"),
@@ -212,7 +277,7 @@ pub fn initialize_sync_timer(
 }
 
 /// Initialize timers with specified mode
-fn initialize_timers_with_mode(
+pub fn initialize_timers_with_mode(
     timer_init_prog: &libbpf_rs::ProgramMut,
     mode: sync_timer_mode,
 ) -> Result<(), SyncTimerError> {
@@ -16,7 +16,7 @@ impl BpfErrorHandler {
         let handler = Rc::new(RefCell::new(Self {}));
 
         // Subscribe to timer migration events
-        let dispatcher = bpf_loader.dispatcher_mut();
+        let mut dispatcher = bpf_loader.dispatcher_mut();
         dispatcher.subscribe_method(
             msg_type::MSG_TYPE_TIMER_MIGRATION_DETECTED as u32,
             handler.clone(),
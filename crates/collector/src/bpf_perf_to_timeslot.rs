@@ -4,7 +4,9 @@ use std::rc::Rc;
 use log::error;
 use tokio::sync::mpsc;
 
-use bpf::{msg_type, BpfLoader, PerfMeasurementMsg};
+use bpf::{
+    msg_type, BpfLoader, CgroupMeasurementMsg, CompactPerfMeasurementMsg, PerfMeasurementMsg,
+};
 use plain;
 
 use crate::bpf_task_tracker::BpfTaskTracker;
@@ -47,13 +49,25 @@ impl BpfPerfToTimeslot {
 
         // Set up BPF event subscriptions
         {
-            let dispatcher = bpf_loader.dispatcher_mut();
+            let mut dispatcher = bpf_loader.dispatcher_mut();
 
             dispatcher.subscribe_method(
                 msg_type::MSG_TYPE_PERF_MEASUREMENT as u32,
                 processor.clone(),
                 BpfPerfToTimeslot::handle_perf_measurement,
             );
+
+            dispatcher.subscribe_method(
+                msg_type::MSG_TYPE_COMPACT_PERF_MEASUREMENT as u32,
+                processor.clone(),
+                BpfPerfToTimeslot::handle_compact_perf_measurement,
+            );
+
+            dispatcher.subscribe_method(
+                msg_type::MSG_TYPE_CGROUP_MEASUREMENT as u32,
+                processor.clone(),
+                BpfPerfToTimeslot::handle_cgroup_measurement,
+            );
         }
 
         processor
@@ -69,6 +83,25 @@ impl BpfPerfToTimeslot {
             }
         };
 
+        self.process_measurement(event);
+    }
+
+    /// Handle compact performance measurement events by widening them to the
+    /// full format and sharing its processing path
+    fn handle_compact_perf_measurement(&mut self, _ring_index: usize, data: &[u8]) {
+        let event: &CompactPerfMeasurementMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse compact perf measurement event: {:?}", e);
+                return;
+            }
+        };
+
+        self.process_measurement(&PerfMeasurementMsg::from(event));
+    }
+
+    /// Fold one measurement into the current timeslot
+    fn process_measurement(&mut self, event: &PerfMeasurementMsg) {
         // Create metric from the performance measurements
         let metric = Metric::from_deltas(
             event.cycles_delta,
@@ -84,6 +117,27 @@ impl BpfPerfToTimeslot {
         self.current_timeslot.update(pid, metadata, metric);
     }
 
+    /// Handle per-cgroup measurement events (cgroup-level aggregation mode)
+    fn handle_cgroup_measurement(&mut self, _ring_index: usize, data: &[u8]) {
+        let event: &CgroupMeasurementMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse cgroup measurement event: {:?}", e);
+                return;
+            }
+        };
+
+        let metric = Metric::from_deltas(
+            event.cycles_delta,
+            event.instructions_delta,
+            event.llc_misses_delta,
+            event.cache_references_delta,
+            event.time_delta_ns,
+        );
+
+        self.current_timeslot.update_cgroup(event.cgroup_id, metric);
+    }
+
     /// Handle new timeslot events
     fn on_new_timeslot(&mut self, _old_timeslot: u64, new_timeslot: u64) {
         // Create a new empty timeslot with the new timestamp
@@ -10,7 +10,7 @@ use arrow_schema::{DataType, Field, Schema, SchemaRef};
 use log::error;
 use tokio::sync::mpsc;
 
-use bpf::{msg_type, BpfLoader, PerfMeasurementMsg};
+use bpf::{msg_type, BpfLoader, CompactPerfMeasurementMsg, PerfMeasurementMsg};
 use plain;
 
 use crate::bpf_task_tracker::BpfTaskTracker;
@@ -29,6 +29,7 @@ pub fn create_schema() -> SchemaRef {
         Field::new("cache_references", DataType::Int64, false),
         Field::new("is_context_switch", DataType::Boolean, false),
         Field::new("next_tgid", DataType::Int32, true),
+        Field::new("sibling_tgid", DataType::Int32, true),
     ]))
 }
 
@@ -48,6 +49,7 @@ pub struct BpfPerfToTrace {
     cache_references_builder: Int64Builder,
     is_context_switch_builder: BooleanBuilder,
     next_tgid_builder: Int32Builder,
+    sibling_tgid_builder: Int32Builder,
     // Channel for sending completed record batches
     batch_tx: Option<mpsc::Sender<RecordBatch>>,
     // Task tracker for metadata lookup
@@ -82,6 +84,7 @@ impl BpfPerfToTrace {
             cache_references_builder: Int64Builder::with_capacity(capacity),
             is_context_switch_builder: BooleanBuilder::with_capacity(capacity),
             next_tgid_builder: Int32Builder::with_capacity(capacity),
+            sibling_tgid_builder: Int32Builder::with_capacity(capacity),
             batch_tx: Some(batch_tx),
             task_tracker,
             last_flush: Instant::now(),
@@ -91,13 +94,19 @@ impl BpfPerfToTrace {
 
         // Set up BPF event subscriptions
         {
-            let dispatcher = bpf_loader.dispatcher_mut();
+            let mut dispatcher = bpf_loader.dispatcher_mut();
 
             dispatcher.subscribe_method(
                 msg_type::MSG_TYPE_PERF_MEASUREMENT as u32,
                 processor.clone(),
                 BpfPerfToTrace::handle_perf_measurement,
             );
+
+            dispatcher.subscribe_method(
+                msg_type::MSG_TYPE_COMPACT_PERF_MEASUREMENT as u32,
+                processor.clone(),
+                BpfPerfToTrace::handle_compact_perf_measurement,
+            );
         }
 
         processor
@@ -113,6 +122,25 @@ impl BpfPerfToTrace {
             }
         };
 
+        self.process_measurement(ring_index, event);
+    }
+
+    /// Handle compact performance measurement events by widening them to the
+    /// full format and sharing its processing path
+    fn handle_compact_perf_measurement(&mut self, ring_index: usize, data: &[u8]) {
+        let event: &CompactPerfMeasurementMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse compact perf measurement event: {:?}", e);
+                return;
+            }
+        };
+
+        self.process_measurement(ring_index, &PerfMeasurementMsg::from(event));
+    }
+
+    /// Append one measurement to the trace builders
+    fn process_measurement(&mut self, ring_index: usize, event: &PerfMeasurementMsg) {
         // Add event data to builders
         self.timestamp_builder
             .append_value(event.header.timestamp as i64);
@@ -156,6 +184,15 @@ impl BpfPerfToTrace {
             self.next_tgid_builder.append_null();
         }
 
+        // Add the co-runner on the sibling hyperthread - null when there is
+        // no sibling or nothing has run on it yet
+        if event.sibling_tgid != 0 {
+            self.sibling_tgid_builder
+                .append_value(event.sibling_tgid as i32);
+        } else {
+            self.sibling_tgid_builder.append_null();
+        }
+
         self.current_rows += 1;
 
         // Check if we should flush
@@ -188,6 +225,7 @@ impl BpfPerfToTrace {
             Arc::new(self.cache_references_builder.finish()),
             Arc::new(self.is_context_switch_builder.finish()),
             Arc::new(self.next_tgid_builder.finish()),
+            Arc::new(self.sibling_tgid_builder.finish()),
         ];
 
         // Create record batch
@@ -213,6 +251,7 @@ impl BpfPerfToTrace {
         self.cache_references_builder = Int64Builder::with_capacity(self.capacity);
         self.is_context_switch_builder = BooleanBuilder::with_capacity(self.capacity);
         self.next_tgid_builder = Int32Builder::with_capacity(self.capacity);
+        self.sibling_tgid_builder = Int32Builder::with_capacity(self.capacity);
         self.current_rows = 0;
         self.last_flush = Instant::now();
 
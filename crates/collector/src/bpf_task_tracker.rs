@@ -23,7 +23,7 @@ impl BpfTaskTracker {
         }));
 
         // Subscribe to task events
-        let dispatcher = bpf_loader.dispatcher_mut();
+        let mut dispatcher = bpf_loader.dispatcher_mut();
 
         // Subscribe to task metadata events
         dispatcher.subscribe_method(
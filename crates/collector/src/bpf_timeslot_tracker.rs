@@ -4,7 +4,10 @@ use std::rc::Rc;
 use log::error;
 use timeslot::MinTracker;
 
-use bpf::{msg_type, BpfLoader, TimerFinishedProcessingMsg};
+use bpf::{
+    compact_measurement_flags, msg_type, BpfLoader, CompactPerfMeasurementMsg, PerfMeasurementMsg,
+    TickIntervalMsg, TimerFinishedProcessingMsg,
+};
 
 /// Callback type for new timeslot events
 /// Receives (old_timeslot, new_timeslot) where timeslot is the timestamp
@@ -18,25 +21,72 @@ pub struct BpfTimeslotTracker {
 }
 
 impl BpfTimeslotTracker {
-    /// Create a new BpfTimeslotTracker and subscribe to timer events
-    pub fn new(bpf_loader: &mut BpfLoader, num_cpus: usize) -> Rc<RefCell<Self>> {
+    /// Create a new BpfTimeslotTracker and subscribe to timer events.
+    ///
+    /// `timer_interval_ns` is the sync timer tick interval (and therefore
+    /// the timeslot size); `timer_phase_stagger_ns` is the per-CPU phase
+    /// offset step, compensated for when mapping tick timestamps to slots.
+    pub fn new(
+        bpf_loader: &mut BpfLoader,
+        num_cpus: usize,
+        timer_interval_ns: u64,
+        timer_phase_stagger_ns: u64,
+    ) -> Rc<RefCell<Self>> {
+        let phase_offsets = (0..num_cpus)
+            .map(|cpu| (cpu as u64 * timer_phase_stagger_ns) % timer_interval_ns)
+            .collect();
         let tracker = Rc::new(RefCell::new(Self {
-            min_tracker: MinTracker::new(1_000_000, num_cpus),
+            min_tracker: MinTracker::with_phase_offsets(timer_interval_ns, num_cpus, phase_offsets),
             last_min_slot: None,
             subscribers: Vec::new(),
         }));
 
-        // Subscribe to timer finished processing events
-        let dispatcher = bpf_loader.dispatcher_mut();
+        // Subscribe to standalone timer finished processing events. These are
+        // only sent when the tick marker could not ride on a perf measurement
+        // message (first tick on a CPU, or in-kernel aggregation mode).
+        let mut dispatcher = bpf_loader.dispatcher_mut();
         dispatcher.subscribe_method(
             msg_type::MSG_TYPE_TIMER_FINISHED_PROCESSING as u32,
             tracker.clone(),
             BpfTimeslotTracker::handle_timer_finished_processing,
         );
 
+        // Subscribe to tick interval changes from the adaptive tick-rate
+        // controller. The message is emitted on the reporting CPU's tick
+        // path, so its timestamp doubles as a tick boundary for that CPU;
+        // ticks then arrive every interval_ns (still aligned to
+        // base-interval boundaries, so slot assembly is unaffected beyond
+        // the stretched CPU completing its slots less often).
+        dispatcher.subscribe_method(
+            msg_type::MSG_TYPE_TICK_INTERVAL_CHANGE as u32,
+            tracker.clone(),
+            BpfTimeslotTracker::handle_tick_interval_change,
+        );
+
         tracker
     }
 
+    /// Subscribe to perf measurement messages to observe tick-flagged
+    /// measurements, which carry the tick boundary marker.
+    ///
+    /// Registered separately from `new` so measurement processors can
+    /// subscribe in between: for one message, the dispatcher invokes
+    /// subscribers in registration order, and the tick's own measurement must
+    /// land in the closing timeslot before the tracker advances it.
+    pub fn subscribe_tick_measurements(tracker: &Rc<RefCell<Self>>, bpf_loader: &mut BpfLoader) {
+        let mut dispatcher = bpf_loader.dispatcher_mut();
+        dispatcher.subscribe_method(
+            msg_type::MSG_TYPE_PERF_MEASUREMENT as u32,
+            tracker.clone(),
+            BpfTimeslotTracker::handle_perf_measurement,
+        );
+        dispatcher.subscribe_method(
+            msg_type::MSG_TYPE_COMPACT_PERF_MEASUREMENT as u32,
+            tracker.clone(),
+            BpfTimeslotTracker::handle_compact_perf_measurement,
+        );
+    }
+
     /// Subscribe to new timeslot events
     /// Callback receives (old_timeslot, new_timeslot) timestamps
     pub fn subscribe(&mut self, callback: impl Fn(u64, u64) + 'static) {
@@ -56,7 +106,7 @@ impl BpfTimeslotTracker {
         self.subscribe(callback);
     }
 
-    /// Handle timer finished processing events
+    /// Handle standalone timer finished processing events
     fn handle_timer_finished_processing(&mut self, ring_index: usize, data: &[u8]) {
         let event: &TimerFinishedProcessingMsg = match plain::from_bytes(data) {
             Ok(event) => event,
@@ -66,9 +116,61 @@ impl BpfTimeslotTracker {
             }
         };
 
-        // Update the min tracker with the CPU ID and timestamp
-        let timestamp = event.header.timestamp;
+        self.update_timeslot(ring_index, event.header.timestamp);
+    }
+
+    /// Handle tick interval change events from the adaptive tick-rate
+    /// controller, treating them as a tick boundary on the reporting CPU
+    fn handle_tick_interval_change(&mut self, ring_index: usize, data: &[u8]) {
+        let event: &TickIntervalMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse tick interval change event: {:?}", e);
+                return;
+            }
+        };
+
+        self.update_timeslot(ring_index, event.header.timestamp);
+    }
+
+    /// Handle perf measurement events, acting only on tick-flagged
+    /// measurements that carry the tick boundary marker
+    fn handle_perf_measurement(&mut self, ring_index: usize, data: &[u8]) {
+        let event: &PerfMeasurementMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse perf measurement event: {:?}", e);
+                return;
+            }
+        };
+
+        if event.is_timer_tick == 0 {
+            return;
+        }
+
+        self.update_timeslot(ring_index, event.header.timestamp);
+    }
+
+    /// As handle_perf_measurement, for the compact encoding
+    fn handle_compact_perf_measurement(&mut self, ring_index: usize, data: &[u8]) {
+        let event: &CompactPerfMeasurementMsg = match plain::from_bytes(data) {
+            Ok(event) => event,
+            Err(e) => {
+                error!("Failed to parse compact perf measurement event: {:?}", e);
+                return;
+            }
+        };
+
+        if event.flags & compact_measurement_flags::TIMER_TICK == 0 {
+            return;
+        }
+
+        self.update_timeslot(ring_index, event.header.timestamp);
+    }
 
+    /// Record a tick boundary for one CPU and notify subscribers when the
+    /// minimum timeslot across CPUs advances
+    fn update_timeslot(&mut self, ring_index: usize, timestamp: u64) {
         if let Err(e) = self.min_tracker.update(ring_index, timestamp) {
             error!("Failed to update min tracker: {:?}", e);
             return;
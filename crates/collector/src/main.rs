@@ -1,6 +1,6 @@
 use anyhow::Result;
 use arrow_array::RecordBatch;
-use bpf::BpfLoader;
+use bpf::{BpfLoader, EnabledCounters, EventsTransport, LoaderConfig};
 use clap::Parser;
 use env_logger;
 use log::{debug, error, info};
@@ -73,6 +73,140 @@ struct Command {
     /// Enable trace mode (outputs individual events instead of aggregated timeslots)
     #[arg(long, default_value = "false")]
     trace: bool,
+
+    /// Use a shared BPF ring buffer for event output instead of per-CPU perf buffers
+    #[arg(long, default_value = "false")]
+    ringbuf: bool,
+
+    /// Aggregate measurements per process in kernel, flushing once per tick
+    /// instead of emitting one message per context switch (requires --ringbuf)
+    #[arg(long, default_value = "false", requires = "ringbuf")]
+    aggregate_in_kernel: bool,
+
+    /// Aggregate measurements per cgroup instead of per process, collapsing
+    /// all of a container's processes into one record per tick (requires
+    /// --aggregate-in-kernel)
+    #[arg(long, default_value = "false", requires = "aggregate_in_kernel")]
+    aggregate_by_cgroup: bool,
+
+    /// Emit measurements in a compact 32-bit-delta wire encoding (64 instead
+    /// of 88 bytes per message), reducing event buffer pressure and drop
+    /// rates during bursts; oversized deltas escape to the full format
+    #[arg(long, default_value = "false")]
+    compact_measurements: bool,
+
+    /// Comma-separated list of hardware counters to collect
+    /// (cycles, instructions, llc_misses, cache_references)
+    #[arg(
+        long,
+        value_delimiter = ',',
+        default_value = "cycles,instructions,llc_misses,cache_references"
+    )]
+    counters: Vec<String>,
+
+    /// Suppress context-switch measurements for slices shorter than this many
+    /// nanoseconds, folding them into the same process's next measurement
+    /// (0 = disabled)
+    #[arg(long, default_value = "0")]
+    min_slice_ns: u64,
+
+    /// Let the sync timer stretch its interval (up to 64ms) on CPUs with no
+    /// scheduling activity instead of waking them every 1ms. Timeslot
+    /// completion can lag by up to the stretched interval while a CPU idles.
+    #[arg(long, default_value = "false")]
+    tickless_idle: bool,
+
+    /// Adapt each CPU's tick interval to its recent load: busy, healthy CPUs
+    /// tick every timer_interval_ns (the floor), quiet CPUs back off one
+    /// doubling per tick, and CPUs whose outputs are dropping back off to
+    /// shed the collector's own overhead. Interval changes are reported in
+    /// the output stream. Supersedes --tickless-idle
+    #[arg(long, default_value = "false")]
+    adaptive_tick: bool,
+
+    /// Interval ceiling for the adaptive controller, in power-of-two
+    /// multiples of the floor: ceiling = timer_interval_ns << shift
+    #[arg(long, default_value = "4")]
+    adaptive_max_shift: u32,
+
+    /// Context switches per tick at or above which the adaptive controller
+    /// keeps a CPU at the floor interval
+    #[arg(long, default_value = "8")]
+    adaptive_busy_switches: u32,
+
+    /// Sync timer tick interval in nanoseconds (also the timeslot size)
+    #[arg(long, default_value = "1000000")]
+    timer_interval_ns: u64,
+
+    /// Per-CPU tick phase offset step in nanoseconds: CPU n fires
+    /// (n * stagger) % interval past each slot boundary, spreading the
+    /// per-tick measurement burst across the slot (0 = all CPUs together)
+    #[arg(long, default_value = "0")]
+    timer_phase_stagger_ns: u64,
+
+    /// Per-CPU perf buffer size in pages, power of two (0 = size
+    /// automatically from the CPU count)
+    #[arg(long, default_value = "0")]
+    perf_buffer_pages: u32,
+
+    /// Bytes buffered per CPU before the kernel wakes the reader; omit to
+    /// use a quarter of the per-CPU buffer, pass 0 to wake on every event
+    #[arg(long)]
+    perf_wakeup_watermark_bytes: Option<u32>,
+
+    /// Time a sampled subset of BPF handler executions and accumulate
+    /// per-probe duration histograms in kernel
+    #[arg(long, default_value = "false")]
+    probe_timing: bool,
+
+    /// Sample one in 2^shift handler executions when --probe-timing is on
+    #[arg(long, default_value = "10")]
+    probe_timing_sample_shift: u32,
+
+    /// Write the probe duration histograms to this file in Prometheus text
+    /// format every 15 seconds, for a textfile collector or the metrics
+    /// sidecar to serve (requires --probe-timing)
+    #[arg(long, requires = "probe_timing")]
+    probe_timing_textfile: Option<String>,
+}
+
+/// Parse the --counters list into the loader's counter set
+fn parse_counters(names: &[String]) -> Result<EnabledCounters> {
+    let mut counters = EnabledCounters {
+        cycles: false,
+        instructions: false,
+        llc_misses: false,
+        cache_references: false,
+    };
+
+    for name in names {
+        match name.as_str() {
+            "cycles" => counters.cycles = true,
+            "instructions" => counters.instructions = true,
+            "llc_misses" => counters.llc_misses = true,
+            "cache_references" => counters.cache_references = true,
+            other => {
+                return Err(anyhow::anyhow!(
+                    "Unknown counter '{}' (expected cycles, instructions, llc_misses, or cache_references)",
+                    other
+                ))
+            }
+        }
+    }
+
+    Ok(counters)
+}
+
+/// Write the BPF probe duration histograms to a Prometheus textfile,
+/// atomically (write to a temp file, then rename) so scrapers never see a
+/// partial exposition
+fn export_probe_histograms(bpf_loader: &BpfLoader, path: &str) -> Result<()> {
+    let stats = bpf_loader.probe_duration_stats()?;
+    let text = metrics::render_probe_histograms(&stats);
+    let tmp_path = format!("{}.tmp", path);
+    std::fs::write(&tmp_path, text)?;
+    std::fs::rename(&tmp_path, path)?;
+    Ok(())
 }
 
 /// Duration timeout handler - exits when duration completes or cancellation token is triggered
@@ -284,20 +418,52 @@ async fn main() -> Result<()> {
     // Close the tracker since we've added all tasks
     task_tracker.close();
 
-    // Create a BPF loader with the specified verbosity
-    let mut bpf_loader = BpfLoader::new()?;
+    // Create a BPF loader with the selected events transport
+    let loader_config = LoaderConfig {
+        transport: if opts.ringbuf {
+            EventsTransport::RingBuf
+        } else {
+            EventsTransport::PerfArray
+        },
+        in_kernel_aggregation: opts.aggregate_in_kernel,
+        cgroup_aggregation: opts.aggregate_by_cgroup,
+        compact_measurements: opts.compact_measurements,
+        counters: parse_counters(&opts.counters)?,
+        min_slice_ns: opts.min_slice_ns,
+        tickless_idle: opts.tickless_idle,
+        adaptive_tick: opts.adaptive_tick,
+        adaptive_max_shift: opts.adaptive_max_shift,
+        adaptive_busy_switches: opts.adaptive_busy_switches,
+        timer_interval_ns: opts.timer_interval_ns,
+        timer_phase_stagger_ns: opts.timer_phase_stagger_ns,
+        perf_buffer_pages: opts.perf_buffer_pages,
+        perf_wakeup_watermark_bytes: opts.perf_wakeup_watermark_bytes,
+        probe_timing: opts.probe_timing,
+        probe_timing_sample_shift: opts.probe_timing_sample_shift,
+    };
+    let mut bpf_loader = BpfLoader::new(loader_config)?;
 
     // Initialize the sync timer
     bpf_loader.start_sync_timer()?;
 
     // Create PerfEventProcessor with the appropriate mode
-    let processor = PerfEventProcessor::new(&mut bpf_loader, num_cpus, processor_mode);
+    let processor = PerfEventProcessor::new(
+        &mut bpf_loader,
+        num_cpus,
+        opts.timer_interval_ns,
+        opts.timer_phase_stagger_ns,
+        processor_mode,
+    );
 
     // Attach BPF programs
     bpf_loader.attach()?;
 
     info!("Collection started.");
 
+    // Export probe duration histograms periodically while polling
+    const PROBE_EXPORT_INTERVAL: Duration = Duration::from_secs(15);
+    let mut last_probe_export = std::time::Instant::now();
+
     // Run BPF polling in the main thread until signaled to stop
     loop {
         // Check if we should shutdown
@@ -313,10 +479,49 @@ async fn main() -> Result<()> {
             break;
         }
 
+        // Periodically publish the BPF probe duration histograms
+        if let Some(path) = &opts.probe_timing_textfile {
+            if last_probe_export.elapsed() >= PROBE_EXPORT_INTERVAL {
+                last_probe_export = std::time::Instant::now();
+                if let Err(e) = export_probe_histograms(&bpf_loader, path) {
+                    error!("Failed to export probe duration histograms: {}", e);
+                }
+            }
+        }
+
         // Drive the tokio runtime forward
         tokio::task::yield_now().await;
     }
 
+    // Publish a final probe histogram snapshot covering the whole run
+    if let Some(path) = &opts.probe_timing_textfile {
+        if let Err(e) = export_probe_histograms(&bpf_loader, path) {
+            error!("Failed to export probe duration histograms: {}", e);
+        }
+    }
+
+    // Report drop telemetry accumulated over the run: in-kernel drop
+    // counters by message type, and gaps detected from sequence numbers
+    match bpf_loader.drop_counts() {
+        Ok(counts) => {
+            let total: u64 = counts.iter().sum();
+            if total > 0 {
+                error!(
+                    "In-kernel message drops detected: {} total, by message type: {:?}",
+                    total, counts
+                );
+            }
+        }
+        Err(e) => error!("Failed to read in-kernel drop counters: {}", e),
+    }
+    let stats = bpf_loader.dispatcher().stats();
+    if stats.sequence_gaps > 0 {
+        error!(
+            "Sequence gaps detected: {} messages lost before reaching userspace",
+            stats.sequence_gaps
+        );
+    }
+
     // Clean up: shutdown the processor
     processor.borrow_mut().shutdown();
 
@@ -40,3 +40,78 @@ impl Metric {
         }
     }
 }
+
+/// Render BPF probe duration histograms in the Prometheus text exposition
+/// format, as cumulative histograms with power-of-two nanosecond bounds.
+///
+/// The input is one entry per probe as produced by
+/// `BpfLoader::probe_duration_stats`: (probe name, log2 bucket counts,
+/// total sampled nanoseconds). The output is served as-is by a metrics
+/// endpoint or written for a textfile collector to pick up.
+pub fn render_probe_histograms(stats: &[(&'static str, Vec<u64>, u64)]) -> String {
+    let mut out = String::new();
+    out.push_str(
+        "# HELP collector_bpf_probe_duration_nanoseconds Sampled BPF handler execution time.\n",
+    );
+    out.push_str("# TYPE collector_bpf_probe_duration_nanoseconds histogram\n");
+
+    for (name, buckets, sum) in stats {
+        let mut cumulative = 0u64;
+        for (bucket, count) in buckets.iter().enumerate() {
+            cumulative += count;
+            if *count == 0 {
+                continue;
+            }
+            // Bucket 0 holds zero-duration samples; bucket i spans
+            // [2^(i-1), 2^i) ns, so its upper bound is 2^i - 1
+            let le = if bucket == 0 { 0 } else { (1u64 << bucket) - 1 };
+            out.push_str(&format!(
+                "collector_bpf_probe_duration_nanoseconds_bucket{{probe=\"{}\",le=\"{}\"}} {}\n",
+                name, le, cumulative
+            ));
+        }
+        out.push_str(&format!(
+            "collector_bpf_probe_duration_nanoseconds_bucket{{probe=\"{}\",le=\"+Inf\"}} {}\n",
+            name, cumulative
+        ));
+        out.push_str(&format!(
+            "collector_bpf_probe_duration_nanoseconds_sum{{probe=\"{}\"}} {}\n",
+            name, sum
+        ));
+        out.push_str(&format!(
+            "collector_bpf_probe_duration_nanoseconds_count{{probe=\"{}\"}} {}\n",
+            name, cumulative
+        ));
+    }
+
+    out
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_render_probe_histograms() {
+        let mut buckets = vec![0u64; 64];
+        buckets[0] = 1; // one zero-duration sample
+        buckets[10] = 5; // five samples in [512, 1024) ns
+        let stats = vec![("sched_switch", buckets, 4000u64)];
+
+        let text = render_probe_histograms(&stats);
+        assert!(text.contains("# TYPE collector_bpf_probe_duration_nanoseconds histogram"));
+        assert!(text.contains(
+            "collector_bpf_probe_duration_nanoseconds_bucket{probe=\"sched_switch\",le=\"0\"} 1"
+        ));
+        assert!(text.contains(
+            "collector_bpf_probe_duration_nanoseconds_bucket{probe=\"sched_switch\",le=\"1023\"} 6"
+        ));
+        assert!(text.contains(
+            "collector_bpf_probe_duration_nanoseconds_bucket{probe=\"sched_switch\",le=\"+Inf\"} 6"
+        ));
+        assert!(text
+            .contains("collector_bpf_probe_duration_nanoseconds_sum{probe=\"sched_switch\"} 4000"));
+        assert!(text
+            .contains("collector_bpf_probe_duration_nanoseconds_count{probe=\"sched_switch\"} 6"));
+    }
+}
@@ -37,10 +37,17 @@ impl PerfEventProcessor {
     pub fn new(
         bpf_loader: &mut BpfLoader,
         num_cpus: usize,
+        timer_interval_ns: u64,
+        timer_phase_stagger_ns: u64,
         mode: ProcessorMode,
     ) -> Rc<RefCell<Self>> {
         // Create BpfTimeslotTracker (always present)
-        let timeslot_tracker = BpfTimeslotTracker::new(bpf_loader, num_cpus);
+        let timeslot_tracker = BpfTimeslotTracker::new(
+            bpf_loader,
+            num_cpus,
+            timer_interval_ns,
+            timer_phase_stagger_ns,
+        );
 
         // Create BpfErrorHandler
         let error_handler = BpfErrorHandler::new(bpf_loader);
@@ -72,6 +79,12 @@ impl PerfEventProcessor {
             }
         };
 
+        // The tick boundary marker rides on the tick's own perf measurement
+        // message; subscribe the timeslot tracker after the measurement
+        // processors so the measurement lands in the closing timeslot before
+        // the tracker advances it
+        BpfTimeslotTracker::subscribe_tick_measurements(&timeslot_tracker, bpf_loader);
+
         let processor = Rc::new(RefCell::new(Self {
             _timeslot_tracker: timeslot_tracker,
             _error_handler: error_handler,
@@ -8,6 +8,9 @@ pub struct TimeslotData {
     pub start_timestamp: u64,
     /// Map from PID to task data (metadata + metrics)
     pub tasks: HashMap<u32, TaskData>,
+    /// Map from cgroup ID to metrics, populated when the BPF side aggregates
+    /// at the cgroup level instead of per task
+    pub cgroups: HashMap<u64, Metric>,
 }
 
 /// Combines task metadata with metrics
@@ -24,6 +27,7 @@ impl TimeslotData {
         Self {
             start_timestamp,
             tasks: HashMap::new(),
+            cgroups: HashMap::new(),
         }
     }
 
@@ -38,15 +42,30 @@ impl TimeslotData {
         }
     }
 
+    /// Updates or inserts metrics for a given cgroup ID
+    pub fn update_cgroup(&mut self, cgroup_id: u64, metrics: Metric) {
+        self.cgroups.entry(cgroup_id).or_default().add(&metrics);
+    }
+
     /// Returns an iterator over all task data
     pub fn iter_tasks(&self) -> impl Iterator<Item = (&u32, &TaskData)> {
         self.tasks.iter()
     }
 
+    /// Returns an iterator over all per-cgroup metrics
+    pub fn iter_cgroups(&self) -> impl Iterator<Item = (&u64, &Metric)> {
+        self.cgroups.iter()
+    }
+
     /// Returns the number of tracked tasks
     pub fn task_count(&self) -> usize {
         self.tasks.len()
     }
+
+    /// Returns the number of tracked cgroups
+    pub fn cgroup_count(&self) -> usize {
+        self.cgroups.len()
+    }
 }
 
 impl TaskData {
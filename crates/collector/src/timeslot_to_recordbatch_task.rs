@@ -25,21 +25,21 @@ pub fn create_timeslot_schema() -> SchemaRef {
 
 /// Convert a TimeslotData to an Arrow RecordBatch
 pub fn timeslot_to_batch(timeslot: TimeslotData, schema: SchemaRef) -> Result<RecordBatch> {
-    // Get the task count to preallocate builders
-    let task_count = timeslot.task_count();
+    // Get the row count (per-task plus per-cgroup) to preallocate builders
+    let row_count = timeslot.task_count() + timeslot.cgroup_count();
 
     // Create array builders for each column
-    let mut start_time_builder = Int64Builder::with_capacity(task_count);
-    let mut pid_builder = Int32Builder::with_capacity(task_count);
+    let mut start_time_builder = Int64Builder::with_capacity(row_count);
+    let mut pid_builder = Int32Builder::with_capacity(row_count);
     // For StringBuilder, we need both item capacity and estimated data capacity
     // Estimate 16 bytes per string for process names
-    let mut process_name_builder = StringBuilder::with_capacity(task_count, task_count * 16);
-    let mut cgroup_id_builder = Int64Builder::with_capacity(task_count);
-    let mut cycles_builder = Int64Builder::with_capacity(task_count);
-    let mut instructions_builder = Int64Builder::with_capacity(task_count);
-    let mut llc_misses_builder = Int64Builder::with_capacity(task_count);
-    let mut cache_references_builder = Int64Builder::with_capacity(task_count);
-    let mut duration_builder = Int64Builder::with_capacity(task_count);
+    let mut process_name_builder = StringBuilder::with_capacity(row_count, row_count * 16);
+    let mut cgroup_id_builder = Int64Builder::with_capacity(row_count);
+    let mut cycles_builder = Int64Builder::with_capacity(row_count);
+    let mut instructions_builder = Int64Builder::with_capacity(row_count);
+    let mut llc_misses_builder = Int64Builder::with_capacity(row_count);
+    let mut cache_references_builder = Int64Builder::with_capacity(row_count);
+    let mut duration_builder = Int64Builder::with_capacity(row_count);
 
     // Convert timeslot data to arrays
     for (pid, task_data) in timeslot.iter_tasks() {
@@ -71,6 +71,20 @@ pub fn timeslot_to_batch(timeslot: TimeslotData, schema: SchemaRef) -> Result<Re
         duration_builder.append_value(task_data.metrics.time_ns as i64);
     }
 
+    // Per-cgroup rows (cgroup-level aggregation mode): no process identity,
+    // so pid is 0 and the process name is null
+    for (cgroup_id, metrics) in timeslot.iter_cgroups() {
+        start_time_builder.append_value(timeslot.start_timestamp as i64);
+        pid_builder.append_value(0);
+        process_name_builder.append_null();
+        cgroup_id_builder.append_value(*cgroup_id as i64);
+        cycles_builder.append_value(metrics.cycles as i64);
+        instructions_builder.append_value(metrics.instructions as i64);
+        llc_misses_builder.append_value(metrics.llc_misses as i64);
+        cache_references_builder.append_value(metrics.cache_references as i64);
+        duration_builder.append_value(metrics.time_ns as i64);
+    }
+
     // Finish building arrays
     let arrays: Vec<ArrayRef> = vec![
         Arc::new(start_time_builder.finish()),
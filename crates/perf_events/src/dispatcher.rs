@@ -32,6 +32,10 @@ pub struct Stats {
 
     /// Number of messages with no registered callbacks
     pub dropped_messages: usize,
+
+    /// Number of messages lost in the kernel, detected from gaps in the
+    /// per-CPU sequence numbers stamped into sample headers
+    pub sequence_gaps: usize,
 }
 
 /// Dispatcher handles message distribution to subscribers based on message type
@@ -42,6 +46,13 @@ pub struct Dispatcher {
     /// Callbacks for lost sample events
     lost_subscribers: Vec<Box<dyn FnMut(usize, &[u8])>>,
 
+    /// Next expected sequence number per ring, for detecting gaps
+    expected_seq: HashMap<usize, u32>,
+
+    /// Reusable buffer for reassembling events that wrap around a ring's end;
+    /// all other events are borrowed straight from the mmap
+    scratch: Vec<u8>,
+
     /// Statistics counters
     stats: Stats,
 }
@@ -52,6 +63,8 @@ impl Dispatcher {
         Dispatcher {
             sample_subscribers: HashMap::new(),
             lost_subscribers: Vec::new(),
+            expected_seq: HashMap::new(),
+            scratch: Vec::new(),
             stats: Stats::default(),
         }
     }
@@ -93,48 +106,106 @@ impl Dispatcher {
         self.subscribe(message_type, callback);
     }
 
+    /// Dispatch a single sample message to registered subscribers
+    ///
+    /// The data must start with a `SampleHeader`. This is the shared entry
+    /// point for both the perf buffer path (via `dispatch`) and the BPF ring
+    /// buffer path, where the caller derives `ring_index` from the header's
+    /// CPU field.
+    pub fn dispatch_sample(
+        &mut self,
+        ring_index: usize,
+        event_data: &[u8],
+    ) -> Result<(), DispatchError> {
+        let header: &SampleHeader = plain::from_bytes(event_data).map_err(|_e| {
+            DispatchError::InvalidFormat(
+                "Sample event too small to contain message type and timestamp".to_string(),
+            )
+        })?;
+
+        // Detect in-kernel drops from gaps in the per-CPU sequence numbers.
+        // A failed output consumes a sequence number, so the gap equals the
+        // number of messages lost on this ring since the last one seen.
+        if let Some(expected) = self.expected_seq.get(&ring_index) {
+            let gap = header.seq.wrapping_sub(*expected);
+            if gap != 0 {
+                self.stats.sequence_gaps += gap as usize;
+            }
+        }
+        self.expected_seq
+            .insert(ring_index, header.seq.wrapping_add(1));
+
+        // Check if we have subscribers for this message type
+        if let Some(subscribers) = self.sample_subscribers.get_mut(&header.type_) {
+            // Call each subscriber with the ring index and message data
+            for subscriber in subscribers {
+                subscriber(ring_index, event_data);
+            }
+            self.stats.samples_processed += 1;
+        } else {
+            // No subscribers for this message type
+            self.stats.dropped_messages += 1;
+        }
+
+        Ok(())
+    }
+
     /// Dispatch events from the reader to registered subscribers
+    ///
+    /// The event is borrowed directly from the ring's mmap rather than copied
+    /// out; only events that wrap around a ring's end are reassembled into a
+    /// reusable scratch buffer. Subscribers that need the data past the
+    /// callback must copy it themselves (they always did: the buffer was
+    /// freed after dispatch before as well).
     pub fn dispatch(&mut self, reader: &mut Reader) -> Result<(), DispatchError> {
         if reader.is_empty() {
             return Ok(());
         }
 
+        // Move the scratch buffer out so the borrowed event data does not
+        // alias `self` while we call the subscribers
+        let mut scratch = std::mem::take(&mut self.scratch);
+        let result = self.dispatch_current(reader, &mut scratch);
+        self.scratch = scratch;
+        result?;
+
+        // Pop the event from the reader
+        reader.pop()?;
+
+        Ok(())
+    }
+
+    /// Dispatches the reader's current event without consuming it
+    fn dispatch_current(
+        &mut self,
+        reader: &Reader,
+        scratch: &mut Vec<u8>,
+    ) -> Result<(), DispatchError> {
         // Get the current ring and its index
         let (ring, ring_index) = reader.current_ring()?;
 
-        let size = ring.peek_size()?;
-        let mut event_data = vec![0u8; size];
-        ring.peek_copy(&mut event_data, 0)?;
+        let (first, wrapped) = ring.peek_borrow(0)?;
+        let event_data: &[u8] = if wrapped.is_empty() {
+            first
+        } else {
+            scratch.clear();
+            scratch.extend_from_slice(first);
+            scratch.extend_from_slice(wrapped);
+            scratch
+        };
 
         // Check the event type
         match ring.peek_type() {
             PERF_RECORD_SAMPLE => {
                 // The message format after the perf header is defined by the SampleHeader struct
-
-                let header: &SampleHeader = plain::from_bytes(&event_data).map_err(|_e| {
-                    DispatchError::InvalidFormat(
-                        "Sample event too small to contain message type and timestamp".to_string(),
-                    )
-                })?;
-
-                // Check if we have subscribers for this message type
-                if let Some(subscribers) = self.sample_subscribers.get_mut(&header.type_) {
-                    // Call each subscriber with the ring index and message data
-                    for subscriber in subscribers {
-                        subscriber(ring_index, &event_data);
-                    }
-                    self.stats.samples_processed += 1;
-                } else {
-                    // No subscribers for this message type
-                    self.stats.dropped_messages += 1;
-                }
+                self.dispatch_sample(ring_index, event_data)?;
             }
             PERF_RECORD_LOST => {
                 // For lost events, we just pass the raw event data
 
                 // Call lost sample subscribers
                 for subscriber in &mut self.lost_subscribers {
-                    subscriber(ring_index, &event_data);
+                    subscriber(ring_index, event_data);
                 }
                 self.stats.lost_events_processed += 1;
             }
@@ -144,9 +215,6 @@ impl Dispatcher {
             }
         }
 
-        // Pop the event from the reader
-        reader.pop()?;
-
         Ok(())
     }
 
@@ -186,13 +254,15 @@ mod tests {
     unsafe impl Plain for TestMessage {}
 
     // Create a test message
-    fn create_test_message(msg_type: u32, timestamp: u64, data: &[u8]) -> Vec<u8> {
+    fn create_test_message(msg_type: u32, timestamp: u64, seq: u32, data: &[u8]) -> Vec<u8> {
         let mut message = Vec::with_capacity(size_of::<TestMessage>());
         let msg = TestMessage {
             header: SampleHeader {
                 size: 8,
                 type_: msg_type,
                 timestamp,
+                cpu: 0,
+                seq,
             },
             data: data.try_into().unwrap(),
         };
@@ -262,11 +332,11 @@ mod tests {
         ring1.start_write_batch();
 
         // FOO message
-        let foo_msg = create_test_message(MSG_TYPE_FOO, 100, b"FOO DATA");
+        let foo_msg = create_test_message(MSG_TYPE_FOO, 100, 0, b"FOO DATA");
         ring1.write(&foo_msg, PERF_RECORD_SAMPLE).unwrap();
 
         // BAR message
-        let bar_msg = create_test_message(MSG_TYPE_BAR, 200, b"BAR DATA");
+        let bar_msg = create_test_message(MSG_TYPE_BAR, 200, 1, b"BAR DATA");
         ring1.write(&bar_msg, PERF_RECORD_SAMPLE).unwrap();
 
         // Lost event
@@ -277,7 +347,7 @@ mod tests {
 
         // Write another message to ring2
         ring2.start_write_batch();
-        let foo_msg2 = create_test_message(MSG_TYPE_FOO, 150, b"FOO DATA");
+        let foo_msg2 = create_test_message(MSG_TYPE_FOO, 150, 0, b"FOO DATA");
         ring2.write(&foo_msg2, PERF_RECORD_SAMPLE).unwrap();
         ring2.finish_write_batch();
 
@@ -298,6 +368,7 @@ mod tests {
         assert_eq!(stats.lost_events_processed, 1);
         assert_eq!(stats.callback_errors, 0);
         assert_eq!(stats.dropped_messages, 0);
+        assert_eq!(stats.sequence_gaps, 0);
 
         // Finish reading
         reader.finish().unwrap();
@@ -323,7 +394,7 @@ mod tests {
 
         // Write a message with no subscribers
         ring.start_write_batch();
-        let unknown_msg = create_test_message(999, 100, b"UNKNOWN ");
+        let unknown_msg = create_test_message(999, 100, 0, b"UNKNOWN ");
         ring.write(&unknown_msg, PERF_RECORD_SAMPLE).unwrap();
         ring.finish_write_batch();
 
@@ -403,10 +474,10 @@ mod tests {
 
         // Write test messages
         ring.start_write_batch();
-        let foo_msg = create_test_message(MSG_TYPE_FOO, 100, b"FOO DATA");
+        let foo_msg = create_test_message(MSG_TYPE_FOO, 100, 0, b"FOO DATA");
         ring.write(&foo_msg, PERF_RECORD_SAMPLE).unwrap();
 
-        let bar_msg = create_test_message(MSG_TYPE_BAR, 200, b"BAR DATA");
+        let bar_msg = create_test_message(MSG_TYPE_BAR, 200, 1, b"BAR DATA");
         ring.write(&bar_msg, PERF_RECORD_SAMPLE).unwrap();
         ring.finish_write_batch();
 
@@ -425,6 +496,43 @@ mod tests {
         reader.finish().unwrap();
     }
 
+    #[test]
+    fn test_sequence_gap_detection() {
+        // Setup test rings and reader
+        let page_size = 4096u64;
+        let n_pages = 2u32;
+        let mut data = vec![0u8; (page_size * (1 + u64::from(n_pages))) as usize];
+
+        let mut ring = unsafe { PerfRing::init_contiguous(&mut data, n_pages, page_size).unwrap() };
+
+        // Create the reader
+        let mut reader = Reader::new();
+        reader
+            .add_ring(unsafe { PerfRing::init_contiguous(&mut data, n_pages, page_size).unwrap() })
+            .unwrap();
+
+        // Create the dispatcher
+        let mut dispatcher = Dispatcher::new();
+        dispatcher.subscribe(MSG_TYPE_FOO, |_, _| {});
+
+        // Write messages with sequence numbers 0, 1, then 4: two lost
+        ring.start_write_batch();
+        for seq in [0u32, 1, 4] {
+            let msg = create_test_message(MSG_TYPE_FOO, 100 + u64::from(seq), seq, b"FOO DATA");
+            ring.write(&msg, PERF_RECORD_SAMPLE).unwrap();
+        }
+        ring.finish_write_batch();
+
+        // Dispatch all events
+        reader.start().unwrap();
+        dispatcher.dispatch_all(&mut reader).unwrap();
+        reader.finish().unwrap();
+
+        let stats = dispatcher.stats();
+        assert_eq!(stats.samples_processed, 3);
+        assert_eq!(stats.sequence_gaps, 2);
+    }
+
     #[test]
     fn test_invalid_message_format() {
         // Setup test rings and reader
@@ -238,15 +238,21 @@ pub fn open_perf_counter(
     counter_type: HardwareCounter,
 ) -> Result<(), PerfEventError> {
     // Create and configure perf event attributes
+    let mut attr = hardware_counter_attr(counter_type);
+
+    // Open the events
+    open_events(map, &mut attr)
+}
+
+/// Builds the perf event attributes for a hardware counter.
+fn hardware_counter_attr(counter_type: HardwareCounter) -> sys::bindings::perf_event_attr {
     let mut attr = sys::bindings::perf_event_attr::default();
     attr.size = std::mem::size_of::<sys::bindings::perf_event_attr>() as u32;
 
-    // Set common attributes
     attr.type_ = sys::bindings::PERF_TYPE_HARDWARE;
     attr.read_format = (sys::bindings::PERF_FORMAT_TOTAL_TIME_ENABLED
         | sys::bindings::PERF_FORMAT_TOTAL_TIME_RUNNING) as u64;
 
-    // Set counter-specific configuration
     match counter_type {
         HardwareCounter::Cycles => {
             attr.config = sys::bindings::PERF_COUNT_HW_CPU_CYCLES as u64;
@@ -262,8 +268,94 @@ pub fn open_perf_counter(
         }
     }
 
-    // Open the events
-    open_events(map, &mut attr)
+    attr
+}
+
+/// Opens a set of hardware counters as a single perf event group per CPU and
+/// updates each counter's map with its file descriptors.
+///
+/// The first entry is the group leader; the remaining counters are opened
+/// with `group_fd` pointing at the leader on the same CPU. Grouped counters
+/// are scheduled on and off the PMU together, so their values are mutually
+/// consistent — no skew from multiplexing between the reads.
+///
+/// # Arguments
+///
+/// * `counters` - Pairs of (map, counter type); each map receives the file
+///   descriptors of its counter
+///
+/// # Returns
+///
+/// * `Ok(())` on success
+/// * `Err(PerfEventError)` on failure
+pub fn open_perf_counter_group(
+    counters: &mut [(&mut MapMut, HardwareCounter)],
+) -> Result<(), PerfEventError> {
+    if counters.is_empty() {
+        return Ok(());
+    }
+
+    // Determine number of CPUs from the leader's map max entries
+    let n_cpu = counters[0]
+        .0
+        .info()
+        .map(|info| info.info.max_entries as i32)
+        .map_err(PerfEventError::MapInfoError)?;
+
+    // fds[counter_index][cpu]
+    let mut fds: Vec<Vec<i32>> = vec![Vec::with_capacity(n_cpu as usize); counters.len()];
+
+    // Helper to close everything opened so far on error
+    let close_all = |fds: &[Vec<i32>]| {
+        for counter_fds in fds {
+            for &fd in counter_fds {
+                unsafe {
+                    libc::close(fd);
+                }
+            }
+        }
+    };
+
+    for cpu in 0..n_cpu {
+        let mut group_fd = -1;
+
+        for (index, (_, counter_type)) in counters.iter().enumerate() {
+            let mut attr = hardware_counter_attr(*counter_type);
+
+            let fd = unsafe {
+                sys::perf_event_open(
+                    &mut attr,
+                    -1, // pid (all threads)
+                    cpu,
+                    group_fd,
+                    sys::bindings::PERF_FLAG_FD_CLOEXEC as u64,
+                )
+            };
+
+            if fd < 0 {
+                close_all(&fds);
+                return Err(PerfEventError::OpenError {
+                    cpu,
+                    source: io::Error::last_os_error(),
+                });
+            }
+
+            if index == 0 {
+                group_fd = fd;
+            }
+            fds[index].push(fd);
+        }
+    }
+
+    // Update each counter's map with its file descriptors
+    for (index, (map, _)) in counters.iter_mut().enumerate() {
+        if let Err(e) = update_map_with_fds(map, &fds[index]) {
+            close_all(&fds);
+            return Err(e);
+        }
+    }
+
+    Ok(())
 }
 
 /// Enables all perf events stored in the map.
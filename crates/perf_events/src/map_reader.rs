@@ -4,6 +4,7 @@
 //! ring buffers connected to an eBPF map.
 
 use std::io;
+use std::os::unix::io::RawFd;
 use std::slice;
 
 use crate::{MmapStorage, PerfRing, PerfRingError, Reader, ReaderError, Storage, StorageError};
@@ -43,6 +44,10 @@ pub enum PerfMapError {
     /// Error adding a ring to the reader
     #[error("failed to add ring to reader: {0}")]
     ReaderAddRingError(ReaderError),
+
+    /// Error setting up or waiting on the epoll instance
+    #[error("epoll error: {0}")]
+    EpollError(#[source] io::Error),
 }
 
 /// PerfMapReader manages perf ring buffers connected to an eBPF map
@@ -51,6 +56,10 @@ pub struct PerfMapReader {
     _storage: Vec<MmapStorage>,
     /// Reader for the perf rings
     reader: Reader,
+    /// Epoll instance watching all per-CPU perf fds, so the consumer can
+    /// block until the kernel signals readiness (watermark reached) instead
+    /// of sweeping the rings on a fixed schedule
+    epoll_fd: RawFd,
 }
 
 impl PerfMapReader {
@@ -122,12 +131,56 @@ impl PerfMapReader {
         // Update the map with all file descriptors at once
         helpers::update_map_with_fds(map, &fds).map_err(PerfMapError::PerfEventError)?;
 
+        // Register every per-CPU fd with one epoll instance. With a non-zero
+        // watermark the kernel only marks an fd readable once the configured
+        // number of bytes is buffered, turning each wakeup into a batch.
+        let epoll_fd = unsafe { libc::epoll_create1(libc::EPOLL_CLOEXEC) };
+        if epoll_fd < 0 {
+            return Err(PerfMapError::EpollError(io::Error::last_os_error()));
+        }
+        for &fd in &fds {
+            let mut event = libc::epoll_event {
+                events: libc::EPOLLIN as u32,
+                u64: fd as u64,
+            };
+            let ret = unsafe { libc::epoll_ctl(epoll_fd, libc::EPOLL_CTL_ADD, fd, &mut event) };
+            if ret < 0 {
+                let err = io::Error::last_os_error();
+                unsafe { libc::close(epoll_fd) };
+                return Err(PerfMapError::EpollError(err));
+            }
+        }
+
         Ok(PerfMapReader {
             _storage: storage,
             reader,
+            epoll_fd,
         })
     }
 
+    /// Block until at least one per-CPU buffer is ready to read (the kernel
+    /// signals readiness once the wakeup watermark is reached) or the
+    /// timeout elapses. Returns the number of ready buffers (0 on timeout).
+    pub fn wait(&self, timeout_ms: i32) -> Result<usize, PerfMapError> {
+        let mut events = [libc::epoll_event { events: 0, u64: 0 }; 64];
+        let ret = unsafe {
+            libc::epoll_wait(
+                self.epoll_fd,
+                events.as_mut_ptr(),
+                events.len() as i32,
+                timeout_ms,
+            )
+        };
+        if ret < 0 {
+            let err = io::Error::last_os_error();
+            if err.kind() == io::ErrorKind::Interrupted {
+                return Ok(0);
+            }
+            return Err(PerfMapError::EpollError(err));
+        }
+        Ok(ret as usize)
+    }
+
     /// Returns a reference to the underlying perf reader
     pub fn reader(&self) -> &Reader {
         &self.reader
@@ -139,6 +192,12 @@ impl PerfMapReader {
     }
 }
 
+impl Drop for PerfMapReader {
+    fn drop(&mut self) {
+        unsafe { libc::close(self.epoll_fd) };
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1,5 +1,5 @@
 use plain::Plain;
-use std::collections::BinaryHeap;
+use std::collections::binary_heap::{BinaryHeap, PeekMut};
 use std::{cmp::Ordering as CmpOrdering, mem::offset_of};
 use thiserror::Error;
 
@@ -30,6 +30,8 @@ pub struct SampleHeader {
     pub size: u32,
     pub type_: u32,
     pub timestamp: u64,
+    pub cpu: u32,
+    pub seq: u32,
 }
 unsafe impl Plain for SampleHeader {}
 
@@ -164,20 +166,33 @@ impl Reader {
     }
 
     /// Consumes the current event and updates the heap
+    ///
+    /// The winning ring's heap entry is updated in place via `peek_mut`
+    /// (one sift-down) rather than popped and re-pushed (two sifts). When
+    /// one ring holds a run of consecutive-timestamp events - the common
+    /// case when draining a batch, since each CPU's events are already
+    /// ordered - the entry stays at the top and the sift is a no-op, so
+    /// the per-event merge cost amortizes to a couple of comparisons.
     pub fn pop(&mut self) -> Result<(), ReaderError> {
         if !self.active {
             return Err(ReaderError::NotActive);
         }
 
-        let Some(entry) = self.heap.pop() else {
+        let Some(mut entry) = self.heap.peek_mut() else {
             return Err(ReaderError::BufferEmpty);
         };
-        self.in_heap[entry.ring_index] = false;
+        let idx = entry.ring_index;
 
-        self.rings[entry.ring_index].pop()?;
+        self.rings[idx].pop()?;
 
-        // Update the heap entry for this ring
-        self.maintain_heap_entry(entry.ring_index)?;
+        if self.rings[idx].bytes_remaining() == 0 {
+            PeekMut::pop(entry);
+            self.in_heap[idx] = false;
+        } else {
+            // Re-key the entry for the ring's next event; the heap
+            // restores ordering when `entry` is dropped
+            entry.timestamp = Self::next_timestamp(&self.rings[idx]);
+        }
 
         Ok(())
     }
@@ -201,24 +216,9 @@ impl Reader {
             return Ok(());
         };
 
-        // Get the timestamp for the current entry
-        let mut timestamp = 0;
-        if self.rings[idx].peek_type() == PERF_RECORD_SAMPLE {
-            // Sample records have an 8-byte timestamp after the header
-            // Skip the first 8 bytes (RECORD_SAMPLE's size and our message type) and read the timestamp
-            let mut buf = [0u8; 8];
-            if self.rings[idx]
-                .peek_copy(&mut buf, offset_of!(SampleHeader, timestamp) as u16)
-                .is_ok()
-            {
-                timestamp = u64::from_le_bytes(buf);
-            }
-        }
-        // if we cannot read the timestamp, leave it as 0 (most urgent to process)
-
         // Update or add the entry
         let entry = PerfEntry {
-            timestamp,
+            timestamp: Self::next_timestamp(&self.rings[idx]),
             ring_index: idx,
         };
 
@@ -228,6 +228,28 @@ impl Reader {
 
         Ok(())
     }
+
+    /// Reads the timestamp of a non-empty ring's next event
+    ///
+    /// Returns 0 (most urgent to process) for non-sample records, malformed
+    /// sample records, and failed timestamp reads; see `maintain_heap_entry`.
+    fn next_timestamp(ring: &PerfRing) -> u64 {
+        if ring.peek_type() != PERF_RECORD_SAMPLE {
+            return 0;
+        }
+
+        // Sample records have an 8-byte timestamp after the header
+        // Skip the first 8 bytes (RECORD_SAMPLE's size and our message type) and read the timestamp
+        let mut buf = [0u8; 8];
+        if ring
+            .peek_copy(&mut buf, offset_of!(SampleHeader, timestamp) as u16)
+            .is_ok()
+        {
+            return u64::from_le_bytes(buf);
+        }
+
+        0
+    }
 }
 
 impl Default for Reader {
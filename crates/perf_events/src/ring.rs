@@ -280,6 +280,44 @@ impl PerfRing {
         Ok(())
     }
 
+    /// Borrows the next event's data directly from the ring buffer, without
+    /// copying it out of the mmap.
+    ///
+    /// Returns the event data (after skipping `offset` bytes) as two slices:
+    /// the second slice is empty unless the event wraps around the end of the
+    /// buffer, in which case it holds the part that wrapped. The slices are
+    /// only valid until the event is popped; callers that need the data past
+    /// that point must copy it (see `peek_copy`).
+    pub fn peek_borrow(&self, offset: u16) -> Result<(&[u8], &[u8]), PerfRingError> {
+        let size = self.peek_size()?;
+
+        if usize::from(offset) > size {
+            return Err(PerfRingError::SizeExceeded);
+        }
+        let len = size - usize::from(offset);
+
+        unsafe {
+            let header_size = std::mem::size_of::<PerfEventHeader>();
+            let start_pos =
+                ((self.head + header_size as u64 + u64::from(offset)) & self.buf_mask) as usize;
+
+            if start_pos + len <= self.data_len {
+                // Data is contiguous
+                Ok((
+                    std::slice::from_raw_parts(self.data.add(start_pos), len),
+                    &[],
+                ))
+            } else {
+                // Data wraps around buffer end
+                let first_len = self.data_len - start_pos;
+                Ok((
+                    std::slice::from_raw_parts(self.data.add(start_pos), first_len),
+                    std::slice::from_raw_parts(self.data, len - first_len),
+                ))
+            }
+        }
+    }
+
     /// Consumes the current event
     pub fn pop(&mut self) -> Result<(), PerfRingError> {
         if self.tail == self.head {
@@ -415,6 +453,67 @@ mod tests {
         assert_eq!(remaining, 0);
     }
 
+    #[test]
+    fn test_peek_borrow() {
+        let page_size = 4096u64;
+        let n_pages = 2u32;
+        let mut data = vec![0u8; (page_size * (1 + u64::from(n_pages))) as usize];
+
+        let mut ring = unsafe { PerfRing::init_contiguous(&mut data, n_pages, page_size).unwrap() };
+
+        // Fill most of the buffer so the second event wraps around the end
+        let data_size = page_size as usize - size_of::<PerfEventHeader>() - 10;
+        let mut test_data = vec![0u8; data_size];
+        for (i, byte) in test_data.iter_mut().enumerate() {
+            *byte = (i % 256) as u8;
+        }
+
+        ring.start_write_batch();
+        ring.write(&test_data, 1).unwrap();
+        ring.write(&test_data, 2).unwrap();
+        ring.finish_write_batch();
+
+        ring.start_read_batch();
+
+        // First event is contiguous: one slice, empty remainder
+        let (first, second) = ring.peek_borrow(0).unwrap();
+        assert!(second.is_empty());
+        assert_eq!(&first[..data_size], &test_data[..]);
+
+        // Borrowing with an offset skips into the same data
+        let (first, second) = ring.peek_borrow(8).unwrap();
+        assert!(second.is_empty());
+        assert_eq!(&first[..data_size - 8], &test_data[8..]);
+
+        // Offset past the event size is rejected
+        assert!(matches!(
+            ring.peek_borrow(u16::MAX),
+            Err(PerfRingError::SizeExceeded)
+        ));
+
+        ring.pop().unwrap();
+        ring.finish_read_batch();
+
+        // Free up space, then write a third event that wraps
+        ring.start_write_batch();
+        ring.write(&test_data, 3).unwrap();
+        ring.finish_write_batch();
+
+        ring.start_read_batch();
+        ring.pop().unwrap(); // skip the second event
+
+        // Third event wraps: data comes back in two pieces
+        let (first, second) = ring.peek_borrow(0).unwrap();
+        assert!(!second.is_empty());
+        let mut reassembled = Vec::with_capacity(first.len() + second.len());
+        reassembled.extend_from_slice(first);
+        reassembled.extend_from_slice(second);
+        assert_eq!(&reassembled[..data_size], &test_data[..]);
+
+        ring.pop().unwrap();
+        ring.finish_read_batch();
+    }
+
     #[test]
     fn test_wraparound() {
         let page_size = 4096u64;
@@ -64,6 +64,11 @@ pub struct MinTracker {
     /// Size of each time slot in nanoseconds
     time_slot_size: u64,
 
+    /// Per-CPU phase offset in nanoseconds, subtracted from each CPU's
+    /// timestamps before mapping them to time slots. Empty when no
+    /// compensation is needed.
+    phase_offsets: Vec<u64>,
+
     /// Latest timestamp reported by each CPU
     cpu_timestamps: Vec<Option<u64>>,
 
@@ -93,6 +98,53 @@ impl MinTracker {
     pub fn new(time_slot_size: u64, num_cpus: usize) -> Self {
         Self {
             time_slot_size,
+            phase_offsets: Vec::new(),
+            cpu_timestamps: vec![None; num_cpus],
+            time_slot_counts: BTreeMap::new(),
+            uninitialized_cpus: num_cpus,
+        }
+    }
+
+    /// Creates a new MinTracker that compensates for per-CPU phase offsets.
+    ///
+    /// When tick sources are deliberately staggered within the time slot
+    /// (CPU `n` fires `phase_offsets[n]` nanoseconds past the boundary),
+    /// each CPU's timestamps are shifted back by its offset before being
+    /// mapped to a slot, so a staggered tick still reports the slot whose
+    /// boundary it represents.
+    ///
+    /// # Arguments
+    ///
+    /// * `time_slot_size` - The size of each time slot in nanoseconds
+    /// * `num_cpus` - The number of CPUs to track
+    /// * `phase_offsets` - Per-CPU offsets in nanoseconds; must have one
+    ///   entry per CPU
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// use timeslot::MinTracker;
+    ///
+    /// // CPU 1 ticks 250ns after each 1000ns boundary
+    /// let mut tracker = MinTracker::with_phase_offsets(1000, 2, vec![0, 250]);
+    ///
+    /// tracker.update(0, 3000).unwrap(); // Slot 3000
+    /// tracker.update(1, 3250).unwrap(); // Compensated to 3000
+    /// assert_eq!(tracker.get_min(), Some(3000));
+    /// ```
+    pub fn with_phase_offsets(
+        time_slot_size: u64,
+        num_cpus: usize,
+        phase_offsets: Vec<u64>,
+    ) -> Self {
+        assert_eq!(
+            phase_offsets.len(),
+            num_cpus,
+            "phase_offsets must have one entry per CPU"
+        );
+        Self {
+            time_slot_size,
+            phase_offsets,
             cpu_timestamps: vec![None; num_cpus],
             time_slot_counts: BTreeMap::new(),
             uninitialized_cpus: num_cpus,
@@ -146,8 +198,13 @@ impl MinTracker {
         // Get the current timestamp for this CPU
         let prev_timestamp = self.cpu_timestamps[cpu_id];
 
+        // Shift the timestamp back by this CPU's phase offset (if any), so
+        // staggered ticks map to the slot whose boundary they represent
+        let phase_offset = self.phase_offsets.get(cpu_id).copied().unwrap_or(0);
+        let adjusted = timestamp.saturating_sub(phase_offset);
+
         // Calculate the time slot for the new timestamp
-        let new_slot = timestamp / self.time_slot_size;
+        let new_slot = adjusted / self.time_slot_size;
 
         match prev_timestamp {
             None => {
@@ -164,7 +221,7 @@ impl MinTracker {
                 }
 
                 // Calculate the previous time slot
-                let current_slot = prev / self.time_slot_size;
+                let current_slot = prev.saturating_sub(phase_offset) / self.time_slot_size;
 
                 // Only update if the time slot has changed
                 if current_slot != new_slot {
@@ -360,6 +417,24 @@ mod tests {
         assert_eq!(tracker.get_min(), Some(7000));
     }
 
+    #[test]
+    fn test_phase_offset_compensation() {
+        // CPU 0 ticks on the boundary, CPU 1 ticks 250ns late by design
+        let mut tracker = MinTracker::with_phase_offsets(1000, 2, vec![0, 250]);
+
+        tracker.update(0, 3000).unwrap();
+        tracker.update(1, 3250).unwrap();
+
+        // Both ticks represent the slot starting at 3000
+        assert_eq!(tracker.get_min(), Some(3000));
+
+        // The staggered CPU advancing to the next tick moves the minimum
+        tracker.update(1, 4250).unwrap();
+        assert_eq!(tracker.get_min(), Some(3000));
+        tracker.update(0, 4000).unwrap();
+        assert_eq!(tracker.get_min(), Some(4000));
+    }
+
     #[test]
     fn test_multiple_updates_same_time_slot() {
         let mut tracker = MinTracker::new(1000, 2);
@@ -0,0 +1,59 @@
+#!/bin/bash
+set -e
+
+# Function to log to stderr
+log() {
+    echo "$@" >&2
+}
+
+# Function to print usage
+usage() {
+    echo "Usage: $0 [-t <threads>] [-i <iterations>] [-o <output_file>]"
+    echo
+    echo "Run the RMID allocator microbenchmark and collect the report"
+    echo
+    echo "Options:"
+    echo "  -t <threads>     Number of benchmark threads (default: all online CPUs)"
+    echo "  -i <iterations>  Iterations per thread per scenario (default: 100000)"
+    echo "  -o <output_file> Output file for the report (default: rmid_bench_results.txt)"
+    echo "  -h               Show this help message"
+    exit 1
+}
+
+THREADS=0
+ITERATIONS=100000
+OUTPUT="rmid_bench_results.txt"
+
+while getopts "t:i:o:h" opt; do
+    case $opt in
+        t) THREADS=$OPTARG ;;
+        i) ITERATIONS=$OPTARG ;;
+        o) OUTPUT=$OPTARG ;;
+        h|*) usage ;;
+    esac
+done
+
+cleanup() {
+    if lsmod | grep -q "rmid_bench_module"; then
+        sudo rmmod rmid_bench_module
+    fi
+}
+trap cleanup EXIT
+
+log "Building benchmark module..."
+make rmid_bench
+
+log "Loading benchmark module (threads=$THREADS iterations=$ITERATIONS)..."
+sudo dmesg -c > /dev/null  # Clear dmesg buffer
+sudo insmod build/rmid_bench_module.ko nr_threads=$THREADS iterations=$ITERATIONS
+
+log "Waiting for benchmark completion..."
+while ! sudo dmesg | grep -q "rmid_bench: done"; do
+    sleep 1
+done
+
+log "Collecting report..."
+sudo cat /proc/rmid_bench > "$OUTPUT"
+
+log "Report written to $OUTPUT; summary:"
+grep -v "bucket" "$OUTPUT" >&2
@@ -1,6 +1,38 @@
 #ifndef COLLECTOR_H
 #define COLLECTOR_H
 
+#include <linux/types.h>
+
 #define LOG_PREFIX "Memory Collector: "
 
+/*
+ * Binary RMID snapshot, returned by reading /proc/unvariance_collector: one
+ * header followed by num_records records covering RMIDs 1..max_rmid. Built
+ * in a single pass under the allocator lock, so it is internally
+ * consistent; the generation stamp (bumped on every RMID bind and free)
+ * lets userspace compare successive snapshots without walking the records.
+ */
+struct rmid_snapshot_header {
+    __u32 magic;        /* RMID_SNAPSHOT_MAGIC */
+    __u32 record_size;  /* sizeof(struct rmid_snapshot_record) */
+    __u32 num_records;
+    __u32 reserved;
+    __u64 generation;   /* Allocator generation at snapshot time */
+    __u64 timestamp;    /* ktime_get_ns() at snapshot time */
+};
+
+#define RMID_SNAPSHOT_MAGIC 0x52534e50  /* "RSNP" */
+
+/* Flags for struct rmid_snapshot_record */
+#define RMID_SNAPSHOT_FLAG_ALLOCATED (1 << 0)
+
+struct rmid_snapshot_record {
+    __u32 rmid;
+    __u32 flags;
+    __s32 tgid;   /* 0 when the RMID is free or reserved but unbound */
+    __u32 reserved;
+    char comm[16];  /* TASK_COMM_LEN */
+    __u64 last_free_timestamp;
+};
+
 #endif
@@ -9,11 +9,14 @@
 #include <linux/list.h>
 #include <linux/spinlock.h>
 #include <linux/slab.h>
+#include <linux/topology.h>
+#include <linux/cpuhotplug.h>
 #include "rdt.h"
 #include <linux/workqueue.h>
 #include "procfs.h"
 #include "rmid_allocator.h"
 #include "sync_timer.h"
+#include "sample_ring.h"
 #include "collector.h"
 
 MODULE_LICENSE("GPL");
@@ -21,6 +24,29 @@ MODULE_AUTHOR("Memory Collector Project");
 MODULE_DESCRIPTION("Memory subsystem monitoring for Kubernetes");
 MODULE_VERSION("1.0");
 
+// Timer cadence. tick_interval_ns sets how often each CPU samples;
+// tick_stagger_ns offsets CPU n's expiration by (n * tick_stagger_ns) %
+// tick_interval_ns past the boundary, spreading the per-tick measurement
+// burst across the interval instead of firing all CPUs simultaneously.
+static ulong tick_interval_ns = NSEC_PER_MSEC;
+module_param(tick_interval_ns, ulong, 0444);
+MODULE_PARM_DESC(tick_interval_ns, "Measurement tick interval in nanoseconds (default 1000000)");
+
+static ulong tick_stagger_ns = 0;
+module_param(tick_stagger_ns, ulong, 0444);
+MODULE_PARM_DESC(tick_stagger_ns, "Per-CPU tick phase offset step in nanoseconds (default 0)");
+
+// Sample ring sizing. Each CPU gets a ring of sample_ring_records fixed-size
+// records mmap-ed into the collector; pollers are woken once a ring
+// accumulates sample_ring_watermark unconsumed records.
+static uint sample_ring_records = 4096;
+module_param(sample_ring_records, uint, 0444);
+MODULE_PARM_DESC(sample_ring_records, "Per-CPU sample ring capacity in records, power of two (default 4096)");
+
+static uint sample_ring_watermark = 64;
+module_param(sample_ring_watermark, uint, 0444);
+MODULE_PARM_DESC(sample_ring_watermark, "Unconsumed records per ring that trigger a poll wakeup (default 64)");
+
 // Define the tracepoint
 #define CREATE_TRACE_POINTS
 #include "tracepoints.h"
@@ -32,27 +58,63 @@ MODULE_VERSION("1.0");
 static struct rmid_alloc rmid_allocator;
 static spinlock_t rmid_lock;
 
+// Per-CPU RMID magazines: the fork and exit paths allocate and free from
+// CPU-local caches, taking rmid_lock only to refill or drain a batch
+static struct rmid_magazine __percpu *rmid_magazines;
+
 // Forward declarations of new functions
-static void assign_rmids_to_leaders(void);
-static void propagate_leader_rmids(void);
 static void reset_cpu_rmid(void *info);
 static int detect_and_init_rmid_allocator(void);
-static void rdt_timer_tick(struct rdt_state *rdt_state);
+static void compute_rdt_scan_partitions(int excluded_cpu);
+static void free_mbm_states(void);
+static void rdt_timer_tick(struct cpu_state *state);
 static void dump_existing_rmids(void);
+static ssize_t rmid_snapshot(void **buf);
 
 // Global procfs data
 static struct procfs_data collector_procfs = {
     .name = "unvariance_collector",
     .dump_callback = dump_existing_rmids,
+    .snapshot_callback = rmid_snapshot,
 };
 
 struct cpu_state {
     struct rdt_state rdt_state;
+    // This CPU's share of the per-tick RDT scan: MBM/occupancy counters are
+    // per-L3-domain, so the RMID space is partitioned round-robin among the
+    // online CPUs of each domain and exactly one CPU per domain reads each
+    // RMID. Recomputed on CPU hotplug so a departing reader's share fails
+    // over to the domain's remaining CPUs.
+    u32 scan_index;   // This CPU's index among the online CPUs of its L3 domain
+    u32 scan_stride;  // Number of online CPUs sharing this CPU's L3 domain
+    // Software 64-bit extension state for the MBM counters, indexed by RMID.
+    // Points into this CPU's entry of mbm_domain_states: the state is shared
+    // with the other CPUs of the L3 domain, and the scan partition makes this
+    // CPU the sole writer of its share's entries.
+    struct rdt_mbm_state *mbm_states;
 };
 
+// Shared MBM extension state, one array per L3 domain (physical package id)
+// with one entry per RMID. MSR_IA32_QM_CTR returns the same counter for an
+// RMID from any CPU of the domain, so when a partition change moves an RMID
+// to a different reader the new reader inherits the previous raw baseline and
+// accumulator, and the exported byte counts stay monotonic across failover.
+static struct rdt_mbm_state **mbm_domain_states;
+static int mbm_domain_count;
+
+// Dynamic CPU hotplug state for timer start/stop and partition failover
+static enum cpuhp_state collector_cpuhp_state;
+
 static struct cpu_state __percpu *cpu_states;
 static struct sync_timer collector_timer;
 
+// Per-CPU sample rings behind /dev/unvariance_samples. When active, the
+// measurement paths append binary records to the current CPU's ring instead
+// of firing tracepoints; if ring setup fails at load we fall back to the
+// tracepoint output so the module still produces data.
+static struct sample_ring_set collector_rings;
+static bool sample_rings_active;
+
 // Forward declare timer callback
 static enum hrtimer_restart timer_fn(struct hrtimer *timer);
 
@@ -63,13 +125,16 @@ static struct workqueue_struct *collector_wq;
 static bool rdt_hardware_support = false;
 
 /*
- * Assign RMID to a task
- * If task is a thread group leader, allocates a new RMID if needed
- * If task is a thread, copies RMID from group leader
+ * Assign RMID to a task, lazily: allocates an RMID for the task's thread
+ * group leader if it has none, then copies the leader's RMID if the task is
+ * a thread. Called from the fork probe and on first observation of a task
+ * in the sched_switch probe, so RMIDs materialize as tasks actually run
+ * instead of through a stop-the-world scan at module load.
  */
 static void assign_rmid_to_task(struct task_struct *task)
 {
     struct task_struct *group_leader;
+    struct rmid_magazine *mag;
     u32 rmid;
     unsigned long flags;
 
@@ -80,32 +145,42 @@ static void assign_rmid_to_task(struct task_struct *task)
     if (!group_leader)
         return;
 
-    // If this is not the group leader, just copy the leader's RMID
-    if (task != group_leader) {
-        task->rmid = group_leader->rmid;
-        return;
-    }
-
-    // First check without lock
-    if (group_leader->rmid)
-        return;  // Leader already has an RMID
-
-    // We do not assign RMIDs to kernel threads
-    if ((group_leader->mm == NULL) || (group_leader->flags & PF_KTHREAD))
-        return;
+    // Allocate for the leader if it has none yet, even when observing one
+    // of its threads. We do not assign RMIDs to kernel threads.
+    if (!group_leader->rmid &&
+        group_leader->mm != NULL && !(group_leader->flags & PF_KTHREAD)) {
+        // Hand one out from this CPU's magazine, touching the global lock
+        // only when the magazine needs a refill
+        local_irq_save(flags);
+        mag = this_cpu_ptr(rmid_magazines);
+
+        if (mag->alloc_count == 0) {
+            spin_lock(&rmid_lock);
+            mag->alloc_count = rmid_alloc_batch(&rmid_allocator, mag->alloc_rmids,
+                                                RMID_MAGAZINE_BATCH, ktime_get_ns());
+            spin_unlock(&rmid_lock);
+        }
 
-    // No RMID assigned to leader, need to allocate one
-    spin_lock_irqsave(&rmid_lock, flags);
+        if (mag->alloc_count) {
+            rmid = mag->alloc_rmids[mag->alloc_count - 1];
+            // cmpxchg against a concurrent assignment (e.g. a sched_switch
+            // probe racing a fork probe on another CPU); the loser keeps
+            // its RMID in the magazine
+            if (cmpxchg(&group_leader->rmid, 0, rmid) == 0) {
+                mag->alloc_count--;
+                rmid_bind(&rmid_allocator, rmid, group_leader->comm,
+                          group_leader->tgid, ktime_get_ns());
+            }
+            // Note: if allocation fails, leader->rmid remains 0
+        }
 
-    // Recheck after acquiring lock
-    if (!group_leader->rmid) {
-        // Allocate new RMID for the process
-        rmid = rmid_alloc(&rmid_allocator, group_leader->comm, group_leader->tgid, ktime_get_ns());
-        group_leader->rmid = rmid;
-        // Note: if allocation fails, leader->rmid remains 0
+        local_irq_restore(flags);
     }
 
-    spin_unlock_irqrestore(&rmid_lock, flags);
+    // Threads inherit the leader's RMID (possibly still 0 if allocation
+    // failed; a later observation retries)
+    if (task != group_leader)
+        task->rmid = group_leader->rmid;
 }
 
 /*
@@ -123,7 +198,9 @@ void dump_existing_rmids(void)
         spin_lock_irqsave(&rmid_lock, flags);
         
         info = rmid_get_info(&rmid_allocator, i);
-        if (info && rmid_is_allocated(&rmid_allocator, i)) {
+        // Skip RMIDs reserved in a per-CPU magazine but not yet bound to a
+        // process (off the free list with no identity recorded)
+        if (info && rmid_is_allocated(&rmid_allocator, i) && info->tgid) {
             trace_rmid_existing(
                 info->rmid,
                 info->comm,
@@ -137,54 +214,122 @@ void dump_existing_rmids(void)
 }
 
 /*
- * Read memory bandwidth counter for given RMID and output to trace
+ * Build the binary RMID snapshot for reads of the procfs entry: one header
+ * and one record per RMID, copied out in a single pass under the allocator
+ * lock. This is the cheap resync path for a restarting collector — one lock
+ * acquisition and one read() instead of a trace replay of every RMID — and
+ * the generation stamp lets userspace detect concurrent mutations by
+ * comparing successive snapshots.
  */
-static void rdt_timer_tick(struct rdt_state *rdt_state)
+static ssize_t rmid_snapshot(void **buf)
 {
-    int cpu = smp_processor_id();
-    u64 now = ktime_get_ns();
-    int llc_occupancy_err = 0;
-    u64 llc_occupancy_val = 0;
-    int mbm_total_err = 0;
-    u64 mbm_total_val = 0;
-    int mbm_local_err = 0;
-    u64 mbm_local_val = 0;
-
-    // for now, just output the first 4 RMID, on CPUs 0..3
-    if (cpu > 4) {
-        return;
-    }
+    struct rmid_snapshot_header *hdr;
+    struct rmid_snapshot_record *records;
+    u32 num = rmid_allocator.max_rmid;  // Records cover RMIDs 1..max_rmid
+    size_t size = sizeof(*hdr) + (size_t)num * sizeof(*records);
+    unsigned long flags;
+    u32 i;
 
-    // if we support cache, read it on this CPU
-    if (rdt_state->supports_llc_occupancy) {
-        llc_occupancy_err = rdt_read_llc_occupancy(cpu, &llc_occupancy_val);
-    } else {
-        llc_occupancy_err = -ENODEV;
-    }
+    BUILD_BUG_ON(sizeof(records->comm) != TASK_COMM_LEN);
 
-    // if we support mbm, read it on this CPU
-    if (rdt_state->supports_mbm_total) {
-        mbm_total_err = rdt_read_mbm_total(cpu, &mbm_total_val);
-    } else {
-        mbm_total_err = -ENODEV;
-    }
+    hdr = kvmalloc(size, GFP_KERNEL);
+    if (!hdr)
+        return -ENOMEM;
+    records = (struct rmid_snapshot_record *)(hdr + 1);
 
-    // if we support mbm local, read it on this CPU
-    if (rdt_state->supports_mbm_local) {
-        mbm_local_err = rdt_read_mbm_local(cpu, &mbm_local_val);
-    } else {
-        mbm_local_err = -ENODEV;
+    hdr->magic = RMID_SNAPSHOT_MAGIC;
+    hdr->record_size = sizeof(*records);
+    hdr->num_records = num;
+    hdr->reserved = 0;
+
+    spin_lock_irqsave(&rmid_lock, flags);
+    hdr->generation = atomic64_read(&rmid_allocator.generation);
+    hdr->timestamp = ktime_get_ns();
+    for (i = 1; i <= num; i++) {
+        struct rmid_info *info = &rmid_allocator.rmids[i];
+        struct rmid_snapshot_record *rec = &records[i - 1];
+
+        rec->rmid = info->rmid;
+        rec->flags = rmid_is_allocated(&rmid_allocator, i) ?
+            RMID_SNAPSHOT_FLAG_ALLOCATED : 0;
+        rec->tgid = info->tgid;
+        rec->reserved = 0;
+        memcpy(rec->comm, info->comm, TASK_COMM_LEN);
+        rec->last_free_timestamp = info->last_free_timestamp;
     }
+    spin_unlock_irqrestore(&rmid_lock, flags);
+
+    *buf = hdr;
+    return size;
+}
+
+/*
+ * Read the RDT counters for this CPU's share of the allocated RMID space and
+ * output one trace sample per RMID. Each tick, every CPU walks the RMIDs at
+ * its round-robin offset within its L3 domain (rmid - 1 ≡ scan_index mod
+ * scan_stride), skipping unallocated RMIDs via the lock-free bitmap, so each
+ * RMID is read exactly once per domain per tick.
+ */
+static void rdt_timer_tick(struct cpu_state *state)
+{
+    struct rdt_state *rdt_state = &state->rdt_state;
+    u64 now = ktime_get_ns();
+    u32 rmid;
 
-    trace_rdt_sample(cpu, now, llc_occupancy_val, llc_occupancy_err, mbm_total_val, mbm_total_err, mbm_local_val, mbm_local_err);
+    if (!state->scan_stride)
+        return;  // Not participating in the scan (offline or uninitialized)
+
+    for (rmid = 1 + state->scan_index; rmid <= rmid_allocator.max_rmid;
+         rmid += state->scan_stride) {
+        struct rdt_sample sample;
+
+        if (!rmid_is_allocated_lockless(&rmid_allocator, rmid))
+            continue;
+
+        // Read all supported events for this RMID in one batched call
+        rdt_read_all_events(rdt_state, rmid, &sample);
+
+        // Extend the raw MBM readings to monotonic 64-bit byte counts
+        if (state->mbm_states)
+            rdt_mbm_extend(rdt_state, &state->mbm_states[rmid], &sample);
+
+        if (sample_rings_active) {
+            struct sample_record rec = {
+                .type = SAMPLE_RECORD_TYPE_RDT,
+                .timestamp = now,
+                .rmid = rmid,
+                .llc_occupancy = sample.llc_occupancy_val,
+                .mbm_total = sample.mbm_total_val,
+                .mbm_local = sample.mbm_local_val,
+                .llc_occupancy_err = sample.llc_occupancy_err,
+                .mbm_total_err = sample.mbm_total_err,
+                .mbm_local_err = sample.mbm_local_err,
+            };
+            sample_ring_emit(&collector_rings, &rec);
+        } else {
+            trace_rdt_sample(rmid, now, sample.llc_occupancy_val, sample.llc_occupancy_err,
+                             sample.mbm_total_val, sample.mbm_total_err,
+                             sample.mbm_local_val, sample.mbm_local_err);
+        }
+    }
 }
 
 static void collect_sample_on_current_cpu(bool is_context_switch)
 {
-    trace_measure_perf_counters(is_context_switch, current->rmid);
+    if (sample_rings_active) {
+        struct sample_record rec = {
+            .type = SAMPLE_RECORD_TYPE_PERF,
+            .timestamp = ktime_get_ns(),
+            .rmid = current->rmid,
+            .flags = is_context_switch ? SAMPLE_RECORD_FLAG_CONTEXT_SWITCH : 0,
+        };
+        sample_ring_emit(&collector_rings, &rec);
+    } else {
+        trace_measure_perf_counters(is_context_switch, current->rmid);
+    }
 
     struct cpu_state *state = this_cpu_ptr(cpu_states);
-    rdt_timer_tick(&state->rdt_state);
+    rdt_timer_tick(state);
 }
 
 static void probe_sched_switch(void *data,
@@ -193,6 +338,11 @@ static void probe_sched_switch(void *data,
                              struct task_struct *next,
                              unsigned int prev_state)
 {
+    // Lazy assignment: give the incoming task its RMID on first observation
+    // (tasks that predate module load never saw the fork probe)
+    if (!next->rmid)
+        assign_rmid_to_task(next);
+
     // Only collect sample if RMID is changing
     if (prev->rmid != next->rmid) {
         // Collect sample for the outgoing task
@@ -238,12 +388,68 @@ static enum hrtimer_restart timer_fn(struct hrtimer *timer)
 {
     // Collect the sample
     collect_sample_on_current_cpu(false);
-    
+
     // Let the sync timer module handle the restart
     return sync_timer_restart(timer, &collector_timer);
 }
 
-// Add this function after the other RMID-related functions
+/*
+ * CPU hotplug callbacks, both running on the CPU in question: an incoming
+ * CPU enumerates its RDT state, joins the scan partition, and starts its
+ * tick; an outgoing CPU stops its tick and hands its share of the RMID
+ * scan over to the remaining CPUs of its L3 domain.
+ */
+static int collector_cpu_online(unsigned int cpu)
+{
+    struct cpu_state *state = this_cpu_ptr(cpu_states);
+    int ret;
+
+    ret = rdt_init_cpu(&state->rdt_state);
+    if (ret) {
+        pr_err(LOG_PREFIX "Failed to initialize RDT state for CPU %d: error %d\n",
+               cpu, ret);
+        return ret;
+    }
+
+    compute_rdt_scan_partitions(-1);
+    return sync_timer_online_cpu(&collector_timer);
+}
+
+static int collector_cpu_offline(unsigned int cpu)
+{
+    sync_timer_offline_cpu(&collector_timer);
+    // The outgoing CPU is still in the online mask here; exclude it so its
+    // share fails over immediately
+    compute_rdt_scan_partitions(cpu);
+    return 0;
+}
+
+/*
+ * Return everything cached in the per-CPU magazines to the global allocator:
+ * pending frees with their original timestamps, and reserved-but-unbound
+ * RMIDs. Called on module exit after the tracepoint probes are gone.
+ */
+static void drain_rmid_magazines(void)
+{
+    int cpu;
+    unsigned long flags;
+
+    for_each_possible_cpu(cpu) {
+        struct rmid_magazine *mag = per_cpu_ptr(rmid_magazines, cpu);
+
+        spin_lock_irqsave(&rmid_lock, flags);
+        rmid_free_batch(&rmid_allocator, mag->free_entries, mag->free_count);
+        mag->free_count = 0;
+        while (mag->alloc_count) {
+            mag->alloc_count--;
+            rmid_free(&rmid_allocator, mag->alloc_rmids[mag->alloc_count], ktime_get_ns());
+        }
+        spin_unlock_irqrestore(&rmid_lock, flags);
+    }
+}
+
+// Reset every task's RMID; used at unload so a later module instance starts
+// from a clean slate
 static void reset_all_task_rmids(void)
 {
     struct task_struct *task;
@@ -278,11 +484,26 @@ static void probe_sched_process_free(void *data, struct task_struct *task)
 
     rmid = leader->rmid;
     if (rmid) {
-        spin_lock_irqsave(&rmid_lock, flags);
-
-        rmid_free(&rmid_allocator, rmid, ktime_get_ns());
+        struct rmid_magazine *mag;
+
+        // Stash the free in this CPU's magazine, recording the timestamp so
+        // the minimum-free-time quarantine starts now; the global lock is
+        // taken only when the magazine fills up and a whole batch drains
+        local_irq_save(flags);
+        mag = this_cpu_ptr(rmid_magazines);
+
+        mag->free_entries[mag->free_count].rmid = rmid;
+        mag->free_entries[mag->free_count].timestamp = ktime_get_ns();
+        mag->free_count++;
+
+        if (mag->free_count == RMID_MAGAZINE_CAPACITY) {
+            spin_lock(&rmid_lock);
+            rmid_free_batch(&rmid_allocator, mag->free_entries, mag->free_count);
+            spin_unlock(&rmid_lock);
+            mag->free_count = 0;
+        }
 
-        spin_unlock_irqrestore(&rmid_lock, flags);
+        local_irq_restore(flags);
     }
 }
 
@@ -362,8 +583,9 @@ static int __init memory_collector_init(void)
 
     pr_info(LOG_PREFIX "loading module\n");
 
-    // Reset all task RMIDs at the start
-    reset_all_task_rmids();
+    // No task-tree walk here: task RMIDs are zero (fresh boot, or the
+    // previous instance reset them at unload) and are assigned lazily from
+    // the fork and sched_switch probes as tasks run
 
     // Allocate per-CPU state
     cpu_states = alloc_percpu(struct cpu_state);
@@ -398,6 +620,9 @@ static int __init memory_collector_init(void)
     // Wait for all initialization work to complete
     flush_workqueue(collector_wq);
 
+    // Partition the per-tick RDT scan among the online CPUs of each L3 domain
+    compute_rdt_scan_partitions(-1);
+
     // Initialize RMID allocator after all CPUs are initialized
     ret = detect_and_init_rmid_allocator();
     if (ret) {
@@ -419,25 +644,48 @@ static int __init memory_collector_init(void)
         goto err_cleanup_tracepoints;
     }
 
-    // Two-phase RMID assignment
-    assign_rmids_to_leaders();    // First assign RMIDs to group leaders
-    propagate_leader_rmids();     // Then propagate to all threads
+    // Set up the per-CPU sample rings. Not fatal: on failure the
+    // measurement paths fall back to tracepoint output.
+    ret = sample_ring_init(&collector_rings, "unvariance_samples",
+                           sample_ring_records, sample_ring_watermark);
+    if (ret) {
+        pr_warn(LOG_PREFIX "Sample ring setup failed (%d), falling back to tracepoint output\n", ret);
+    } else {
+        sample_rings_active = true;
+    }
 
     // Initialize sync timer last
-    ret = sync_timer_init(&collector_timer, timer_fn, NSEC_PER_MSEC);
+    ret = sync_timer_init(&collector_timer, timer_fn, tick_interval_ns, tick_stagger_ns);
     if (ret) {
         pr_err(LOG_PREFIX "Failed to initialize sync timer: %d\n", ret);
         goto err_cleanup_procfs;
     }
 
+    // Register hotplug callbacks so late-arriving CPUs join the tick and
+    // the scan, and departing readers fail over. nocalls: CPUs online now
+    // were already set up above.
+    ret = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN, "memory_collector:online",
+                                    collector_cpu_online, collector_cpu_offline);
+    if (ret < 0) {
+        pr_err(LOG_PREFIX "Failed to register hotplug callbacks: %d\n", ret);
+        goto err_destroy_timer;
+    }
+    collector_cpuhp_state = ret;
+
     pr_info(LOG_PREFIX "module loaded\n");
     return 0;
 
+err_destroy_timer:
+    sync_timer_destroy(&collector_timer);
 err_cleanup_procfs:
+    sample_rings_active = false;
+    sample_ring_cleanup(&collector_rings);
     procfs_cleanup(&collector_procfs);
 err_cleanup_tracepoints:
     cleanup_tracepoints();
 err_cleanup_rmid:
+    free_mbm_states();
+    free_percpu(rmid_magazines);
     cleanup_rmid_allocator(&rmid_allocator);
 err_free_works:
     free_percpu(cpu_works);
@@ -454,6 +702,10 @@ static void __exit memory_collector_exit(void)
 
     pr_info(LOG_PREFIX "unloading module\n");
 
+    // Stop reacting to hotplug before tearing down the timers the
+    // callbacks manipulate
+    cpuhp_remove_state_nocalls(collector_cpuhp_state);
+
     // Clean up sync timer first
     sync_timer_destroy(&collector_timer);
 
@@ -478,12 +730,20 @@ static void __exit memory_collector_exit(void)
     // Ensure all tracepoint handlers finished before freeing resources
     tracepoint_synchronize_unregister();
 
+    // All producers are quiesced (timers cancelled, probes gone): tear down
+    // the sample rings
+    sample_rings_active = false;
+    sample_ring_cleanup(&collector_rings);
+
     // Reset RMID to 0 on all CPUs if we have hardware support
     if (rdt_hardware_support) {
         on_each_cpu(reset_cpu_rmid, NULL, 1);
     }
 
-    // Clean up RMID allocator
+    // Return magazine-cached RMIDs, then clean up the RMID allocator
+    drain_rmid_magazines();
+    free_percpu(rmid_magazines);
+    free_mbm_states();
     cleanup_rmid_allocator(&rmid_allocator);
 
     // Free per-CPU state
@@ -495,6 +755,72 @@ static void __exit memory_collector_exit(void)
     pr_info(LOG_PREFIX "done unloading\n");
 }
 
+// Free the per-domain MBM extension state and clear the per-CPU pointers
+// into it (tolerates partial allocation)
+static void free_mbm_states(void)
+{
+    int cpu, domain;
+
+    for_each_possible_cpu(cpu) {
+        struct cpu_state *state = per_cpu_ptr(cpu_states, cpu);
+        state->mbm_states = NULL;
+    }
+
+    for (domain = 0; domain < mbm_domain_count; domain++)
+        kfree(mbm_domain_states[domain]);
+    kfree(mbm_domain_states);
+    mbm_domain_states = NULL;
+    mbm_domain_count = 0;
+}
+
+/*
+ * Partition the RMID scan among the online CPUs of each L3 domain: each CPU
+ * learns its index among the online CPUs sharing its domain and the
+ * domain's online CPU count (the scan stride), so the per-tick walk covers
+ * every RMID exactly once per domain and MSR traffic scales with domains,
+ * not cores. Uses the physical package as the L3 domain, matching the
+ * one-L3-per-socket topology of our fleet.
+ *
+ * Called at init and from the hotplug callbacks; @excluded_cpu (or -1 for
+ * none) is the CPU currently going offline, which is still in the online
+ * mask while its teardown callback runs. CPUs not participating get a zero
+ * stride and skip the scan. Remote CPUs may tick mid-recompute and scan a
+ * transiently inconsistent share for that one tick — an RMID read twice or
+ * missed once — which is harmless: the MBM extension state is shared per
+ * domain, so the second of two readers starts from the first's raw baseline
+ * and accumulates only the interleaving delta, and a missed RMID is simply
+ * picked up with a larger delta on the next tick.
+ */
+static void compute_rdt_scan_partitions(int excluded_cpu)
+{
+    int cpu, other;
+
+    for_each_possible_cpu(cpu) {
+        struct cpu_state *state = per_cpu_ptr(cpu_states, cpu);
+        int domain = topology_physical_package_id(cpu);
+        u32 index = 0;
+        u32 count = 0;
+
+        if (!cpu_online(cpu) || cpu == excluded_cpu) {
+            state->scan_stride = 0;
+            continue;
+        }
+
+        for_each_online_cpu(other) {
+            if (other == excluded_cpu)
+                continue;
+            if (topology_physical_package_id(other) != domain)
+                continue;
+            if (other == cpu)
+                index = count;
+            count++;
+        }
+
+        state->scan_index = index;
+        state->scan_stride = count;
+    }
+}
+
 // RMID allocation and initialization functions
 static int detect_and_init_rmid_allocator(void)
 {
@@ -529,45 +855,52 @@ static int detect_and_init_rmid_allocator(void)
         return ret;
     }
 
-    return 0;
-}
-
-/*
- * Assign RMIDs to all thread group leaders in the system.
- * This should be called before assigning RMIDs to non-leaders.
- */
-static void assign_rmids_to_leaders(void)
-{
-    struct task_struct *task;
-
-    rcu_read_lock();
-    for_each_process(task) {
-        if (task == task->group_leader) {
-            assign_rmid_to_task(task);
-            pr_debug(LOG_PREFIX "assigned RMID %d to leader %s\n", task->rmid, task->comm);
-        }
+    // Allocate the per-CPU magazines (zeroed, so all start empty)
+    rmid_magazines = alloc_percpu(struct rmid_magazine);
+    if (!rmid_magazines) {
+        pr_err(LOG_PREFIX "Failed to allocate per-CPU RMID magazines\n");
+        cleanup_rmid_allocator(&rmid_allocator);
+        return -ENOMEM;
     }
-    rcu_read_unlock();
-}
 
-/*
- * Propagate leader RMIDs to all threads in their groups.
- * This should be called after assign_rmids_to_leaders.
- */
-static void propagate_leader_rmids(void)
-{
-    struct task_struct *task;
-    struct task_struct *thread;
+    // Allocate the MBM extension state, one array per L3 domain with one
+    // entry per RMID (zeroed, so accumulation baselines from the very first
+    // read), and point each CPU at its domain's array
+    for_each_possible_cpu(cpu)
+        mbm_domain_count = max(mbm_domain_count,
+                               topology_physical_package_id(cpu) + 1);
+
+    mbm_domain_states = kcalloc(mbm_domain_count, sizeof(*mbm_domain_states),
+                                GFP_KERNEL);
+    if (!mbm_domain_states) {
+        pr_err(LOG_PREFIX "Failed to allocate MBM extension state\n");
+        mbm_domain_count = 0;
+        free_percpu(rmid_magazines);
+        cleanup_rmid_allocator(&rmid_allocator);
+        return -ENOMEM;
+    }
 
-    rcu_read_lock();
-    for_each_process(task) {
-        for_each_thread(task, thread) {
-            if (thread != thread->group_leader) {
-                thread->rmid = thread->group_leader->rmid;
+    for_each_possible_cpu(cpu) {
+        int domain = topology_physical_package_id(cpu);
+
+        if (!mbm_domain_states[domain]) {
+            mbm_domain_states[domain] =
+                kzalloc(sizeof(struct rdt_mbm_state) * (min_max_rmid + 1),
+                        GFP_KERNEL);
+            if (!mbm_domain_states[domain]) {
+                pr_err(LOG_PREFIX "Failed to allocate MBM extension state\n");
+                free_mbm_states();
+                free_percpu(rmid_magazines);
+                cleanup_rmid_allocator(&rmid_allocator);
+                return -ENOMEM;
             }
         }
+
+        state = per_cpu_ptr(cpu_states, cpu);
+        state->mbm_states = mbm_domain_states[domain];
     }
-    rcu_read_unlock();
+
+    return 0;
 }
 
 // Move reset_cpu_rmid function definition before it's used
@@ -1,11 +1,20 @@
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
 #include <linux/uaccess.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
 #include "procfs.h"
 #include "collector.h"
 
 #define MAX_COMMAND_LENGTH 32
 
+// Snapshot built at open time, consumed by subsequent reads on the same
+// file so chunked reads see one consistent image
+struct procfs_snapshot {
+    void *buf;
+    size_t size;
+};
+
 static ssize_t procfs_write(struct file *file, const char __user *buf,
                            size_t count, loff_t *ppos)
 {
@@ -46,16 +55,72 @@ static ssize_t procfs_write(struct file *file, const char __user *buf,
     return count;
 }
 
+static int procfs_open(struct inode *inode, struct file *file)
+{
+    struct procfs_data *data = pde_data(inode);
+    struct procfs_snapshot *snapshot;
+    ssize_t size;
+
+    // Writers (and readers of entries without a snapshot callback) carry no
+    // per-open state
+    if (!(file->f_mode & FMODE_READ) || !data || !data->snapshot_callback)
+        return 0;
+
+    snapshot = kzalloc(sizeof(*snapshot), GFP_KERNEL);
+    if (!snapshot)
+        return -ENOMEM;
+
+    size = data->snapshot_callback(&snapshot->buf);
+    if (size < 0) {
+        kfree(snapshot);
+        return size;
+    }
+
+    snapshot->size = size;
+    file->private_data = snapshot;
+    return 0;
+}
+
+static ssize_t procfs_read(struct file *file, char __user *buf,
+                           size_t count, loff_t *ppos)
+{
+    struct procfs_snapshot *snapshot = file->private_data;
+
+    if (!snapshot)
+        return -EINVAL;
+
+    return simple_read_from_buffer(buf, count, ppos, snapshot->buf, snapshot->size);
+}
+
+static int procfs_release(struct inode *inode, struct file *file)
+{
+    struct procfs_snapshot *snapshot = file->private_data;
+
+    if (snapshot) {
+        kvfree(snapshot->buf);
+        kfree(snapshot);
+        file->private_data = NULL;
+    }
+    return 0;
+}
+
 static const struct proc_ops procfs_ops = {
+    .proc_open = procfs_open,
+    .proc_read = procfs_read,
     .proc_write = procfs_write,
+    .proc_release = procfs_release,
 };
 
 int procfs_init(struct procfs_data *data)
 {
+    umode_t mode;
+
     if (!data || !data->name)
         return -EINVAL;
 
-    data->proc_entry = proc_create_data(data->name, 0220, NULL, &procfs_ops, data);
+    // Entries expose reads only when a snapshot provider is wired up
+    mode = data->snapshot_callback ? 0640 : 0220;
+    data->proc_entry = proc_create_data(data->name, mode, NULL, &procfs_ops, data);
     if (!data->proc_entry) {
         pr_err(LOG_PREFIX "Failed to create /proc/%s\n", data->name);
         return -ENOMEM;
@@ -10,6 +10,14 @@ struct procfs_data {
     struct proc_dir_entry *proc_entry;  /* Procfs entry pointer */
     const char *name;                   /* Name of the procfs entry */
     void (*dump_callback)(void);        /* Callback for handling dump commands */
+    /*
+     * Optional callback producing a binary snapshot for reads. Must
+     * allocate the snapshot with kvmalloc, store it in *buf and return its
+     * size (or a negative error). The snapshot is built once per open so a
+     * reader sees one consistent image regardless of read chunking; procfs
+     * owns the buffer afterwards and kvfree()s it on release.
+     */
+    ssize_t (*snapshot_callback)(void **buf);
 };
 
 /**
@@ -1,6 +1,9 @@
 #include <linux/init.h>
 #include <linux/module.h>
 #include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
 #include "procfs.h"
 
 MODULE_LICENSE("GPL");
@@ -13,8 +16,23 @@ MODULE_VERSION("1.0");
 #define TEST_RESULT "test_result:"
 
 static struct procfs_data test_procfs;
+static struct procfs_data test_snapshot_procfs;
 static int dump_call_count = 0;
 
+#define TEST_SNAPSHOT_NAME "procfs_test_snapshot"
+#define TEST_SNAPSHOT_CONTENT "snapshot"
+
+static ssize_t test_snapshot_callback(void **buf)
+{
+    char *b = kvmalloc(sizeof(TEST_SNAPSHOT_CONTENT) - 1, GFP_KERNEL);
+
+    if (!b)
+        return -ENOMEM;
+    memcpy(b, TEST_SNAPSHOT_CONTENT, sizeof(TEST_SNAPSHOT_CONTENT) - 1);
+    *buf = b;
+    return sizeof(TEST_SNAPSHOT_CONTENT) - 1;
+}
+
 static void test_dump_callback(void)
 {
     dump_call_count++;
@@ -53,6 +71,54 @@ static bool test_procfs_init(void)
     return passed;
 }
 
+static bool test_procfs_snapshot(void)
+{
+    char data[16] = {0};
+    struct file *filp;
+    loff_t pos = 0;
+    ssize_t n;
+    bool passed = true;
+    int ret;
+
+    test_snapshot_procfs.name = TEST_SNAPSHOT_NAME;
+    test_snapshot_procfs.snapshot_callback = test_snapshot_callback;
+    ret = procfs_init(&test_snapshot_procfs);
+    if (ret != 0) {
+        pr_err(TEST_PREFIX "init with snapshot callback failed: %d\n", ret);
+        passed = false;
+        goto out;
+    }
+
+    // Read the entry back through the VFS to exercise the open (snapshot
+    // build), read, and release paths
+    filp = filp_open("/proc/" TEST_SNAPSHOT_NAME, O_RDONLY, 0);
+    if (IS_ERR(filp)) {
+        pr_err(TEST_PREFIX "failed to open snapshot entry: %ld\n", PTR_ERR(filp));
+        passed = false;
+        goto out;
+    }
+
+    n = kernel_read(filp, data, sizeof(data), &pos);
+    if (n != sizeof(TEST_SNAPSHOT_CONTENT) - 1 ||
+        memcmp(data, TEST_SNAPSHOT_CONTENT, sizeof(TEST_SNAPSHOT_CONTENT) - 1) != 0) {
+        pr_err(TEST_PREFIX "snapshot read returned %zd bytes, content mismatch\n", n);
+        passed = false;
+    }
+
+    // A second read at the same offset should report EOF
+    n = kernel_read(filp, data, sizeof(data), &pos);
+    if (n != 0) {
+        pr_err(TEST_PREFIX "read past snapshot end should return 0, got %zd\n", n);
+        passed = false;
+    }
+
+    filp_close(filp, NULL);
+
+out:
+    pr_info(TEST_RESULT "procfs_snapshot:%s\n", passed ? "pass" : "fail");
+    return passed;
+}
+
 static bool test_procfs_cleanup(void)
 {
     bool passed = true;
@@ -61,6 +127,7 @@ static bool test_procfs_cleanup(void)
     procfs_cleanup(NULL);  // Should not crash
 
     // Test cleanup with valid data
+    procfs_cleanup(&test_snapshot_procfs);
     procfs_cleanup(&test_procfs);
     if (test_procfs.proc_entry != NULL) {
         pr_err(TEST_PREFIX "proc_entry not nulled after cleanup\n");
@@ -78,7 +145,8 @@ static int __init procfs_test_init(void)
     pr_info(TEST_PREFIX "starting tests\n");
 
     all_passed &= test_procfs_init();
-    
+    all_passed &= test_procfs_snapshot();
+
     // Don't run cleanup test yet - we need the procfs entry for external testing
     
     pr_info(TEST_PREFIX "initialization tests %s\n", all_passed ? "passed" : "failed");
@@ -63,6 +63,7 @@ int rdt_init_cpu(struct rdt_state *rdt_state)
     rdt_state->supports_mbm_local = (edx & (1 << 2));
     rdt_state->max_rmid = ecx;
     rdt_state->counter_width = (eax & 0xFF) + 24;
+    rdt_state->counter_scale = ebx ? ebx : 1;  // Bytes per MBM counter unit
     rdt_state->has_overflow_bit = (eax & (1 << 8));
     rdt_state->supports_non_cpu_agent_cache = (eax & (1 << 8));
     rdt_state->supports_non_cpu_agent_mbm = (eax & (1 << 10));
@@ -114,3 +115,57 @@ int rdt_read_mbm_total(u32 rmid, u64 *val) {
 int rdt_read_mbm_local(u32 rmid, u64 *val) {
     return rdt_read_resctrl_value(rmid, QOS_L3_MBM_LOCAL_EVENT_ID, val);
 }
+
+void rdt_read_all_events(struct rdt_state *rdt_state, u32 rmid, struct rdt_sample *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    // Sequence the supported EVTSEL/CTR pairs back-to-back; support flags
+    // were cached at CPU init so unsupported events cost nothing here
+    if (rdt_state->supports_llc_occupancy)
+        out->llc_occupancy_err = rdt_read_resctrl_value(rmid, QOS_L3_OCCUP_EVENT_ID,
+                                                        &out->llc_occupancy_val);
+    else
+        out->llc_occupancy_err = -ENODEV;
+
+    if (rdt_state->supports_mbm_total)
+        out->mbm_total_err = rdt_read_resctrl_value(rmid, QOS_L3_MBM_TOTAL_EVENT_ID,
+                                                    &out->mbm_total_val);
+    else
+        out->mbm_total_err = -ENODEV;
+
+    if (rdt_state->supports_mbm_local)
+        out->mbm_local_err = rdt_read_resctrl_value(rmid, QOS_L3_MBM_LOCAL_EVENT_ID,
+                                                    &out->mbm_local_val);
+    else
+        out->mbm_local_err = -ENODEV;
+}
+
+void rdt_mbm_extend(struct rdt_state *rdt_state, struct rdt_mbm_state *state,
+                    struct rdt_sample *sample)
+{
+    // Modular arithmetic at the enumerated width: (raw - prev) & mask is the
+    // advance even across a single wrap. Assumes the sampling interval is
+    // shorter than the wrap period, which holds by orders of magnitude for
+    // our per-tick scan.
+    u64 width_mask = rdt_state->counter_width >= 64 ?
+        ~0ULL : (1ULL << rdt_state->counter_width) - 1;
+    u64 raw;
+    u64 delta;
+
+    if (sample->mbm_total_err == 0) {
+        raw = sample->mbm_total_val & width_mask;
+        delta = (raw - state->mbm_total_raw) & width_mask;
+        state->mbm_total_raw = raw;
+        state->mbm_total_acc += delta * rdt_state->counter_scale;
+        sample->mbm_total_val = state->mbm_total_acc;
+    }
+
+    if (sample->mbm_local_err == 0) {
+        raw = sample->mbm_local_val & width_mask;
+        delta = (raw - state->mbm_local_raw) & width_mask;
+        state->mbm_local_raw = raw;
+        state->mbm_local_acc += delta * rdt_state->counter_scale;
+        sample->mbm_local_val = state->mbm_local_acc;
+    }
+}
@@ -13,6 +13,22 @@ struct rdt_state {
     bool supports_non_cpu_agent_cache;
     u32 max_rmid;
     u32 counter_width;
+    u32 counter_scale;  // Bytes per MBM counter unit (CPUID.0xF.1:EBX)
+};
+
+// Per-RMID software extension state for the MBM counters: the hardware
+// counters are only counter_width bits wide (24-bit counters wrap in under a
+// second of heavy bandwidth), so readers accumulate modular deltas into
+// monotonically increasing 64-bit byte counts. One instance per RMID per L3
+// domain, shared by the domain's readers — the hardware counter is the same
+// from any CPU of the domain, so the state survives a change of reader;
+// valid as long as some reader samples the RMID faster than the hardware
+// wrap period.
+struct rdt_mbm_state {
+    u64 mbm_total_raw;  // Last raw hardware value, for wrap detection
+    u64 mbm_total_acc;  // Accumulated total bandwidth in bytes
+    u64 mbm_local_raw;
+    u64 mbm_local_acc;  // Accumulated local bandwidth in bytes
 };
 
 /* Function declarations */
@@ -33,6 +49,34 @@ int rdt_read_llc_occupancy(u32 rmid, u64 *val);
 int rdt_read_mbm_total(u32 rmid, u64 *val);
 int rdt_read_mbm_local(u32 rmid, u64 *val);
 
+// One RMID's worth of RDT event readings from rdt_read_all_events().
+// Each event carries its own error code (-ENODEV when unsupported).
+struct rdt_sample {
+    u64 llc_occupancy_val;
+    int llc_occupancy_err;
+    u64 mbm_total_val;
+    int mbm_total_err;
+    u64 mbm_local_val;
+    int mbm_local_err;
+};
+
+/*
+ * Read all supported RDT events for given RMID in one call, sequencing the
+ * EVTSEL/CTR pairs back-to-back. Events unsupported per rdt_state are never
+ * attempted and report -ENODEV. Must run on a CPU of the L3 domain whose
+ * counters are wanted.
+ */
+void rdt_read_all_events(struct rdt_state *rdt_state, u32 rmid, struct rdt_sample *out);
+
+/*
+ * Extend the raw MBM readings in a sample to monotonically increasing 64-bit
+ * byte counts, detecting hardware counter wrap from the enumerated counter
+ * width and applying the enumerated scale factor. Replaces the sample's
+ * mbm_total_val/mbm_local_val in place; readings with errors are left alone.
+ */
+void rdt_mbm_extend(struct rdt_state *rdt_state, struct rdt_mbm_state *state,
+                    struct rdt_sample *sample);
+
 /*
  * Write RMID and CLOSID to MSR_IA32_PQR_ASSOC
  * Returns 0 on success, negative error code on failure
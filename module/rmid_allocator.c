@@ -56,6 +56,8 @@ u32 rmid_alloc(struct rmid_alloc *allocator, const char *comm, pid_t tgid, u64 t
     info->comm[TASK_COMM_LEN - 1] = '\0';
     info->tgid = tgid;
     rmid = info->rmid;
+    set_bit(rmid, allocator->allocated_bitmap);
+    atomic64_inc(&allocator->generation);
 
     // Emit tracepoint for RMID allocation
     trace_rmid_alloc(rmid, comm, tgid, timestamp);
@@ -63,6 +65,51 @@ u32 rmid_alloc(struct rmid_alloc *allocator, const char *comm, pid_t tgid, u64 t
     return rmid;
 }
 
+u32 rmid_alloc_batch(struct rmid_alloc *allocator, u32 *rmids, u32 max_count, u64 timestamp)
+{
+    struct rmid_info *info;
+    u32 count = 0;
+
+    while (count < max_count) {
+        if (list_empty(&allocator->free_list))
+            break;
+
+        // The free list is ordered by free time; stop at the first RMID
+        // still inside the minimum-free-time quarantine
+        info = list_first_entry(&allocator->free_list, struct rmid_info, list);
+        if (timestamp - info->last_free_timestamp < allocator->min_free_time_ns)
+            break;
+
+        list_del_init(&info->list);
+
+        // Not bound to a process until rmid_bind(); clear the identity so
+        // the RMID reads as cached rather than in use
+        info->comm[0] = '\0';
+        info->tgid = 0;
+
+        rmids[count++] = info->rmid;
+    }
+
+    return count;
+}
+
+void rmid_bind(struct rmid_alloc *allocator, u32 rmid, const char *comm, pid_t tgid, u64 timestamp)
+{
+    struct rmid_info *info = rmid_get_info(allocator, rmid);
+
+    if (!info)
+        return;
+
+    strncpy(info->comm, comm, TASK_COMM_LEN - 1);
+    info->comm[TASK_COMM_LEN - 1] = '\0';
+    info->tgid = tgid;
+    set_bit(rmid, allocator->allocated_bitmap);
+    atomic64_inc(&allocator->generation);
+
+    // Emit tracepoint for RMID allocation
+    trace_rmid_alloc(rmid, comm, tgid, timestamp);
+}
+
 void rmid_free(struct rmid_alloc *allocator, u32 rmid, u64 timestamp)
 {
     struct rmid_info *info;
@@ -73,18 +120,29 @@ void rmid_free(struct rmid_alloc *allocator, u32 rmid, u64 timestamp)
     info = &allocator->rmids[rmid];
     info->tgid = 0;
     info->last_free_timestamp = timestamp;
+    clear_bit(rmid, allocator->allocated_bitmap);
+    atomic64_inc(&allocator->generation);
     list_add_tail(&info->list, &allocator->free_list);
 
     // Emit tracepoint for RMID deallocation
     trace_rmid_free(rmid, timestamp);
 }
 
+void rmid_free_batch(struct rmid_alloc *allocator, const struct rmid_free_entry *entries, u32 count)
+{
+    u32 i;
+
+    for (i = 0; i < count; i++)
+        rmid_free(allocator, entries[i].rmid, entries[i].timestamp);
+}
+
 int init_rmid_allocator(struct rmid_alloc *allocator, u32 max_rmid, u64 min_free_time_ns)
 {
     // Initialize allocator structure
     INIT_LIST_HEAD(&allocator->free_list);
     allocator->max_rmid = max_rmid;
     allocator->min_free_time_ns = min_free_time_ns;
+    atomic64_set(&allocator->generation, 0);
 
     // Allocate array of RMID info structures
     allocator->rmids = kzalloc(sizeof(struct rmid_info) * (max_rmid + 1), GFP_KERNEL);
@@ -93,6 +151,15 @@ int init_rmid_allocator(struct rmid_alloc *allocator, u32 max_rmid, u64 min_free
         return -ENOMEM;
     }
 
+    // Allocate the bound-RMID bitmap (zeroed: nothing bound yet)
+    allocator->allocated_bitmap = bitmap_zalloc(max_rmid + 1, GFP_KERNEL);
+    if (!allocator->allocated_bitmap) {
+        pr_err(LOG_PREFIX "Failed to allocate RMID bitmap\n");
+        kfree(allocator->rmids);
+        allocator->rmids = NULL;
+        return -ENOMEM;
+    }
+
     // Initialize all RMIDs (skip RMID 0 as it's reserved)
     for (u32 i = 0; i <= max_rmid; i++) {
         INIT_LIST_HEAD(&allocator->rmids[i].list);
@@ -116,6 +183,8 @@ void cleanup_rmid_allocator(struct rmid_alloc *allocator)
         }
     }
 
+    bitmap_free(allocator->allocated_bitmap);
+    allocator->allocated_bitmap = NULL;
     kfree(allocator->rmids);
     allocator->rmids = NULL;
 }
@@ -1,4 +1,6 @@
 #include <linux/types.h>
+#include <linux/atomic.h>
+#include <linux/bitmap.h>
 #include <linux/list.h>
 #include <linux/spinlock.h>
 #include <linux/sched.h>
@@ -24,6 +26,40 @@ struct rmid_alloc {
     u32 max_rmid;  // Minimum of max_rmid across all CPUs
     struct rmid_info *rmids;  // Array of RMID info, indexed by RMID
     u64 min_free_time_ns;  // Minimum time an RMID must be free before reallocation
+    // Bitmap of RMIDs currently bound to a process, maintained with atomic
+    // bit ops so readers (e.g. the per-tick RDT scan) can test bits without
+    // holding the allocator lock
+    unsigned long *allocated_bitmap;
+    // Bumped on every bind and free; snapshot consumers compare generations
+    // to detect mutations without walking the RMID array
+    atomic64_t generation;
+};
+
+// Per-CPU magazine sizing: a magazine holds up to RMID_MAGAZINE_CAPACITY
+// cached entries and is refilled from the global free list in batches of
+// RMID_MAGAZINE_BATCH, so the common-case fork/exit touches only CPU-local
+// state and the global lock is taken once per batch
+#define RMID_MAGAZINE_CAPACITY 32
+#define RMID_MAGAZINE_BATCH 16
+
+// A freed RMID awaiting a drain to the global free list, with the timestamp
+// of the free preserved so the minimum-free-time quarantine stays accurate
+struct rmid_free_entry {
+    u32 rmid;
+    u64 timestamp;
+};
+
+/**
+ * Per-CPU cache of RMIDs, magazine style: a stack of ready-to-hand-out RMIDs
+ * reserved from the global allocator, and a batch of freed RMIDs awaiting a
+ * drain back to it. Accessed only from its owning CPU with IRQs disabled;
+ * the global allocator lock is needed only for refills and drains.
+ */
+struct rmid_magazine {
+    u32 alloc_count;  // RMIDs ready to hand out
+    u32 free_count;   // Freed RMIDs awaiting a drain
+    u32 alloc_rmids[RMID_MAGAZINE_CAPACITY];
+    struct rmid_free_entry free_entries[RMID_MAGAZINE_CAPACITY];
 };
 
 /**
@@ -53,6 +89,32 @@ void cleanup_rmid_allocator(struct rmid_alloc *allocator);
  */
 u32 rmid_alloc(struct rmid_alloc *allocator, const char *comm, pid_t tgid, u64 timestamp);
 
+/**
+ * Reserve a batch of RMIDs off the free list, for refilling a per-CPU cache
+ * @allocator: Pointer to allocator structure
+ * @rmids: Output array, at least max_count entries
+ * @max_count: Maximum number of RMIDs to reserve
+ * @timestamp: Current timestamp in nanoseconds, for the free-time check
+ * Returns the number of RMIDs reserved (possibly 0)
+ * The reserved RMIDs are off the free list but not yet bound to any process;
+ * bind each with rmid_bind() when handing it out.
+ * Note: Caller must provide synchronization when using from multiple threads/CPUs
+ */
+u32 rmid_alloc_batch(struct rmid_alloc *allocator, u32 *rmids, u32 max_count, u64 timestamp);
+
+/**
+ * Bind a reserved RMID to a process, recording its identity and emitting the
+ * allocation tracepoint
+ * @allocator: Pointer to allocator structure
+ * @rmid: RMID previously reserved with rmid_alloc_batch()
+ * @comm: Command name to associate with RMID
+ * @tgid: Thread group ID to associate with RMID
+ * @timestamp: Current timestamp in nanoseconds
+ * Note: Needs no allocator lock — the RMID is exclusively owned by the
+ * caller's cache between reservation and binding
+ */
+void rmid_bind(struct rmid_alloc *allocator, u32 rmid, const char *comm, pid_t tgid, u64 timestamp);
+
 /**
  * Free an RMID
  * @allocator: Pointer to allocator structure
@@ -62,6 +124,15 @@ u32 rmid_alloc(struct rmid_alloc *allocator, const char *comm, pid_t tgid, u64 t
  */
 void rmid_free(struct rmid_alloc *allocator, u32 rmid, u64 timestamp);
 
+/**
+ * Return a batch of freed RMIDs to the free list, draining a per-CPU cache
+ * @allocator: Pointer to allocator structure
+ * @entries: RMIDs to free, each with the timestamp of its original free
+ * @count: Number of entries
+ * Note: Caller must provide synchronization when using from multiple threads/CPUs
+ */
+void rmid_free_batch(struct rmid_alloc *allocator, const struct rmid_free_entry *entries, u32 count);
+
 /**
  * Get RMID info structure
  * @allocator: Pointer to allocator structure
@@ -79,3 +150,17 @@ struct rmid_info *rmid_get_info(struct rmid_alloc *allocator, u32 rmid);
  * Note: Caller must provide synchronization when using from multiple threads/CPUs
  */
 bool rmid_is_allocated(struct rmid_alloc *allocator, u32 rmid);
+
+/**
+ * Lock-free check whether an RMID is bound to a process, from the atomically
+ * maintained bitmap. Unlike rmid_is_allocated this needs no external
+ * synchronization and excludes RMIDs reserved in a per-CPU cache but not yet
+ * bound, making it suitable for hot scan loops.
+ * @allocator: Pointer to allocator structure
+ * @rmid: RMID to check
+ */
+static inline bool rmid_is_allocated_lockless(struct rmid_alloc *allocator, u32 rmid)
+{
+    return rmid != RMID_INVALID && rmid <= allocator->max_rmid &&
+           test_bit(rmid, allocator->allocated_bitmap);
+}
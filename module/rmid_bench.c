@@ -0,0 +1,487 @@
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/kthread.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/percpu.h>
+#include <linux/cpumask.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/delay.h>
+#include "rmid_allocator.h"
+#include "procfs.h"
+#include "collector.h"
+
+// Define the tracepoint (rmid_allocator.o emits alloc/free events)
+#define CREATE_TRACE_POINTS
+#include "tracepoints.h"
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Memory Collector Project");
+MODULE_DESCRIPTION("Microbenchmark for RMID allocator and probe-path overhead");
+MODULE_VERSION("1.0");
+
+#define BENCH_PREFIX "rmid_bench: "
+
+/*
+ * Drives the RMID allocation paths the collector module exercises from its
+ * tracepoint probes — concurrent alloc/free storms on the global lock,
+ * magazine-amortized fork/exit cycles, and the sched_switch lazy-assignment
+ * race on a shared task — from one pinned kthread per CPU, and reports
+ * per-CPU log2 latency histograms with p50/p99 through the procfs snapshot
+ * read. Run before and after allocator changes to quantify them:
+ *
+ *   insmod build/rmid_bench_module.ko nr_threads=8 iterations=1000000
+ *   cat /proc/rmid_bench           # after "done" appears in dmesg
+ *   rmmod rmid_bench_module
+ */
+
+static uint nr_threads = 0;
+module_param(nr_threads, uint, 0444);
+MODULE_PARM_DESC(nr_threads, "Number of benchmark threads, one per CPU (default: all online CPUs)");
+
+static uint iterations = 100000;
+module_param(iterations, uint, 0444);
+MODULE_PARM_DESC(iterations, "Iterations per thread per scenario (default 100000)");
+
+#define BENCH_MIN_RMIDS 512
+#define BENCH_BUCKETS 40  // log2 ns buckets: covers 1ns .. ~18 minutes
+
+enum bench_scenario {
+    BENCH_ALLOC_FREE_STORM,   // rmid_alloc/rmid_free directly under the global lock
+    BENCH_FORK_STORM,         // magazine-amortized assign + free, like the fork/exit probes
+    BENCH_SWITCH_PROBE,       // lazy-assignment race on a shared leader, like sched_switch
+    BENCH_NUM_SCENARIOS,
+};
+
+static const char *const scenario_names[BENCH_NUM_SCENARIOS] = {
+    "alloc_free_storm",
+    "fork_storm",
+    "sched_switch_probe",
+};
+
+struct bench_hist {
+    u64 buckets[BENCH_BUCKETS];
+    u64 count;
+    u64 sum;
+    u64 min;
+    u64 max;
+};
+
+struct bench_cpu {
+    struct bench_hist hist[BENCH_NUM_SCENARIOS];
+    struct rmid_magazine magazine;
+};
+
+static struct rmid_alloc bench_allocator;
+static spinlock_t bench_lock;
+static struct bench_cpu __percpu *bench_stats;
+static struct task_struct **bench_threads;
+static uint bench_nr_threads;
+static atomic_t threads_done = ATOMIC_INIT(0);
+
+// Stand-in for task->rmid of a shared thread group leader, contended by all
+// benchmark threads in the sched_switch scenario
+static u32 shared_leader_rmid;
+
+static ssize_t bench_snapshot(void **buf);
+
+static struct procfs_data bench_procfs = {
+    .name = "rmid_bench",
+    .snapshot_callback = bench_snapshot,
+};
+
+static void bench_record(struct bench_hist *h, u64 ns)
+{
+    int bucket = ns ? min((int)ilog2(ns), BENCH_BUCKETS - 1) : 0;
+
+    h->buckets[bucket]++;
+    h->count++;
+    h->sum += ns;
+    if (ns < h->min)
+        h->min = ns;
+    if (ns > h->max)
+        h->max = ns;
+}
+
+/*
+ * Scenario 1: every iteration takes the global lock twice, once to allocate
+ * and once to free. This is the fully contended path the magazines exist to
+ * avoid; it bounds allocator cost from above.
+ */
+static void bench_alloc_free_storm(struct bench_hist *h)
+{
+    unsigned long flags;
+    u64 t0, t1;
+    u32 rmid;
+    uint i;
+
+    for (i = 0; i < iterations && !kthread_should_stop(); i++) {
+        t0 = ktime_get_ns();
+
+        spin_lock_irqsave(&bench_lock, flags);
+        rmid = rmid_alloc(&bench_allocator, "bench", 1234, t0);
+        spin_unlock_irqrestore(&bench_lock, flags);
+
+        if (rmid) {
+            spin_lock_irqsave(&bench_lock, flags);
+            rmid_free(&bench_allocator, rmid, ktime_get_ns());
+            spin_unlock_irqrestore(&bench_lock, flags);
+        }
+
+        t1 = ktime_get_ns();
+        bench_record(h, t1 - t0);
+
+        if ((i & 1023) == 0)
+            cond_resched();
+    }
+}
+
+// Magazine-based allocation, mirroring assign_rmid_to_task in the collector
+static u32 bench_magazine_alloc(struct rmid_magazine *mag)
+{
+    u32 rmid = 0;
+
+    if (mag->alloc_count == 0) {
+        spin_lock(&bench_lock);
+        mag->alloc_count = rmid_alloc_batch(&bench_allocator, mag->alloc_rmids,
+                                            RMID_MAGAZINE_BATCH, ktime_get_ns());
+        spin_unlock(&bench_lock);
+    }
+
+    if (mag->alloc_count) {
+        mag->alloc_count--;
+        rmid = mag->alloc_rmids[mag->alloc_count];
+        rmid_bind(&bench_allocator, rmid, "bench", 1234, ktime_get_ns());
+    }
+
+    return rmid;
+}
+
+// Magazine-based free, mirroring probe_sched_process_free in the collector
+static void bench_magazine_free(struct rmid_magazine *mag, u32 rmid)
+{
+    mag->free_entries[mag->free_count].rmid = rmid;
+    mag->free_entries[mag->free_count].timestamp = ktime_get_ns();
+    mag->free_count++;
+
+    if (mag->free_count == RMID_MAGAZINE_CAPACITY) {
+        spin_lock(&bench_lock);
+        rmid_free_batch(&bench_allocator, mag->free_entries, mag->free_count);
+        spin_unlock(&bench_lock);
+        mag->free_count = 0;
+    }
+}
+
+/*
+ * Scenario 2: one fork/exit cycle per iteration through the per-CPU
+ * magazine, touching the global lock only on batch refills and drains. This
+ * is the amortized cost the fork-hot path actually pays.
+ */
+static void bench_fork_storm(struct bench_hist *h, struct rmid_magazine *mag)
+{
+    unsigned long flags;
+    u64 t0, t1;
+    u32 rmid;
+    uint i;
+
+    for (i = 0; i < iterations && !kthread_should_stop(); i++) {
+        t0 = ktime_get_ns();
+
+        local_irq_save(flags);
+        rmid = bench_magazine_alloc(mag);
+        if (rmid)
+            bench_magazine_free(mag, rmid);
+        local_irq_restore(flags);
+
+        t1 = ktime_get_ns();
+        bench_record(h, t1 - t0);
+
+        if ((i & 1023) == 0)
+            cond_resched();
+    }
+}
+
+/*
+ * Scenario 3: the sched_switch lazy-assignment path on a shared leader. All
+ * threads read the shared rmid word; when it is zero they race to allocate
+ * and cmpxchg-bind, the losers keeping their RMID in the magazine. The word
+ * is periodically cleared to re-trigger the race, so the histogram mixes
+ * the common read-only fast path with occasional cmpxchg storms — the mix
+ * the probe sees when new processes appear.
+ */
+static void bench_switch_probe(struct bench_hist *h, struct rmid_magazine *mag)
+{
+    unsigned long flags;
+    u64 t0, t1;
+    u32 rmid;
+    uint i;
+
+    for (i = 0; i < iterations && !kthread_should_stop(); i++) {
+        t0 = ktime_get_ns();
+
+        if (!READ_ONCE(shared_leader_rmid)) {
+            local_irq_save(flags);
+            if (mag->alloc_count == 0) {
+                spin_lock(&bench_lock);
+                mag->alloc_count = rmid_alloc_batch(&bench_allocator,
+                                                    mag->alloc_rmids,
+                                                    RMID_MAGAZINE_BATCH,
+                                                    ktime_get_ns());
+                spin_unlock(&bench_lock);
+            }
+            if (mag->alloc_count) {
+                rmid = mag->alloc_rmids[mag->alloc_count - 1];
+                // Same order as the collector: bind only after winning the
+                // cmpxchg, the loser keeps its RMID in the magazine
+                if (cmpxchg(&shared_leader_rmid, 0, rmid) == 0) {
+                    mag->alloc_count--;
+                    rmid_bind(&bench_allocator, rmid, "bench", 1234,
+                              ktime_get_ns());
+                }
+            }
+            local_irq_restore(flags);
+        }
+
+        t1 = ktime_get_ns();
+        bench_record(h, t1 - t0);
+
+        // Periodically tear the leader down to re-trigger the race
+        if ((i & 255) == 0) {
+            rmid = xchg(&shared_leader_rmid, 0);
+            if (rmid) {
+                local_irq_save(flags);
+                bench_magazine_free(mag, rmid);
+                local_irq_restore(flags);
+            }
+        }
+
+        if ((i & 1023) == 0)
+            cond_resched();
+    }
+}
+
+static int bench_thread_fn(void *arg)
+{
+    struct bench_cpu *stats = arg;
+
+    bench_alloc_free_storm(&stats->hist[BENCH_ALLOC_FREE_STORM]);
+    bench_fork_storm(&stats->hist[BENCH_FORK_STORM], &stats->magazine);
+    bench_switch_probe(&stats->hist[BENCH_SWITCH_PROBE], &stats->magazine);
+
+    if (atomic_inc_return(&threads_done) == bench_nr_threads)
+        pr_info(BENCH_PREFIX "done, read /proc/%s for results\n", bench_procfs.name);
+
+    while (!kthread_should_stop())
+        schedule_timeout_interruptible(HZ / 10);
+
+    return 0;
+}
+
+// Value below which a fraction of the histogram population falls, reported
+// as the upper bound of the bucket containing that rank
+static u64 hist_percentile(const struct bench_hist *h, u64 numerator, u64 denominator)
+{
+    u64 rank = div64_u64(h->count * numerator + denominator - 1, denominator);
+    u64 seen = 0;
+    int b;
+
+    for (b = 0; b < BENCH_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank)
+            return 1ULL << (b + 1);
+    }
+    return 0;
+}
+
+/*
+ * Text report served through the procfs read: one summary line per CPU per
+ * scenario (count, min/p50/p99/max, mean) followed by the nonzero log2
+ * histogram buckets.
+ */
+static ssize_t bench_snapshot(void **buf)
+{
+    // Worst case: a summary line plus every bucket line for each histogram
+    size_t cap = (size_t)BENCH_NUM_SCENARIOS * nr_cpu_ids * (128 + BENCH_BUCKETS * 48) + 128;
+    size_t len = 0;
+    char *out;
+    int s, cpu, b;
+
+    out = kvmalloc(cap, GFP_KERNEL);
+    if (!out)
+        return -ENOMEM;
+
+    len += scnprintf(out + len, cap - len,
+                     "threads=%u iterations=%u completed=%d/%u\n",
+                     bench_nr_threads, iterations,
+                     atomic_read(&threads_done), bench_nr_threads);
+
+    for (s = 0; s < BENCH_NUM_SCENARIOS; s++) {
+        for_each_possible_cpu(cpu) {
+            struct bench_hist *h = &per_cpu_ptr(bench_stats, cpu)->hist[s];
+
+            if (h->count == 0)
+                continue;
+
+            len += scnprintf(out + len, cap - len,
+                             "%s cpu%d count=%llu min=%llu p50=%llu p99=%llu max=%llu mean=%llu\n",
+                             scenario_names[s], cpu, h->count, h->min,
+                             hist_percentile(h, 50, 100),
+                             hist_percentile(h, 99, 100),
+                             h->max, div64_u64(h->sum, h->count));
+
+            for (b = 0; b < BENCH_BUCKETS; b++) {
+                if (!h->buckets[b])
+                    continue;
+                len += scnprintf(out + len, cap - len,
+                                 "%s cpu%d bucket [%llu,%llu) ns: %llu\n",
+                                 scenario_names[s], cpu,
+                                 b ? (1ULL << b) : 0, 1ULL << (b + 1),
+                                 h->buckets[b]);
+            }
+        }
+    }
+
+    *buf = out;
+    return len;
+}
+
+static void bench_stop_threads(void)
+{
+    uint i;
+
+    if (!bench_threads)
+        return;
+
+    for (i = 0; i < bench_nr_threads; i++) {
+        if (bench_threads[i])
+            kthread_stop(bench_threads[i]);
+    }
+    kfree(bench_threads);
+    bench_threads = NULL;
+}
+
+// Return everything the magazines still hold to the allocator
+static void bench_drain_magazines(void)
+{
+    unsigned long flags;
+    int cpu;
+    u32 rmid;
+
+    rmid = xchg(&shared_leader_rmid, 0);
+
+    for_each_possible_cpu(cpu) {
+        struct rmid_magazine *mag = &per_cpu_ptr(bench_stats, cpu)->magazine;
+
+        spin_lock_irqsave(&bench_lock, flags);
+        rmid_free_batch(&bench_allocator, mag->free_entries, mag->free_count);
+        mag->free_count = 0;
+        while (mag->alloc_count) {
+            mag->alloc_count--;
+            rmid_free(&bench_allocator, mag->alloc_rmids[mag->alloc_count],
+                      ktime_get_ns());
+        }
+        spin_unlock_irqrestore(&bench_lock, flags);
+    }
+
+    if (rmid) {
+        spin_lock_irqsave(&bench_lock, flags);
+        rmid_free(&bench_allocator, rmid, ktime_get_ns());
+        spin_unlock_irqrestore(&bench_lock, flags);
+    }
+}
+
+static int __init rmid_bench_init(void)
+{
+    int cpu;
+    uint i;
+    int ret;
+
+    if (!nr_threads)
+        nr_threads = num_online_cpus();
+    bench_nr_threads = min_t(uint, nr_threads, num_online_cpus());
+
+    spin_lock_init(&bench_lock);
+    // Zero quarantine so storms cannot exhaust the RMID space artificially,
+    // and enough RMIDs that every CPU's magazine can fill without starving
+    // the others
+    ret = init_rmid_allocator(&bench_allocator,
+                              max(BENCH_MIN_RMIDS,
+                                  num_possible_cpus() * RMID_MAGAZINE_CAPACITY * 2),
+                              0);
+    if (ret)
+        return ret;
+
+    bench_stats = alloc_percpu(struct bench_cpu);
+    if (!bench_stats) {
+        ret = -ENOMEM;
+        goto err_cleanup_allocator;
+    }
+
+    for_each_possible_cpu(cpu) {
+        struct bench_cpu *stats = per_cpu_ptr(bench_stats, cpu);
+        int s;
+
+        for (s = 0; s < BENCH_NUM_SCENARIOS; s++)
+            stats->hist[s].min = U64_MAX;
+    }
+
+    ret = procfs_init(&bench_procfs);
+    if (ret)
+        goto err_free_stats;
+
+    bench_threads = kcalloc(bench_nr_threads, sizeof(*bench_threads), GFP_KERNEL);
+    if (!bench_threads) {
+        ret = -ENOMEM;
+        goto err_cleanup_procfs;
+    }
+
+    // One thread per online CPU, pinned, until nr_threads are running
+    i = 0;
+    for_each_online_cpu(cpu) {
+        struct task_struct *task;
+
+        if (i == bench_nr_threads)
+            break;
+
+        task = kthread_create(bench_thread_fn, per_cpu_ptr(bench_stats, cpu),
+                              "rmid_bench/%d", cpu);
+        if (IS_ERR(task)) {
+            ret = PTR_ERR(task);
+            pr_err(BENCH_PREFIX "Failed to create thread for CPU %d: %d\n", cpu, ret);
+            bench_stop_threads();
+            goto err_cleanup_procfs;
+        }
+        kthread_bind(task, cpu);
+        bench_threads[i++] = task;
+    }
+
+    for (i = 0; i < bench_nr_threads; i++)
+        wake_up_process(bench_threads[i]);
+
+    pr_info(BENCH_PREFIX "started %u threads, %u iterations per scenario\n",
+            bench_nr_threads, iterations);
+    return 0;
+
+err_cleanup_procfs:
+    procfs_cleanup(&bench_procfs);
+err_free_stats:
+    free_percpu(bench_stats);
+err_cleanup_allocator:
+    cleanup_rmid_allocator(&bench_allocator);
+    return ret;
+}
+
+static void __exit rmid_bench_exit(void)
+{
+    bench_stop_threads();
+    procfs_cleanup(&bench_procfs);
+    bench_drain_magazines();
+    cleanup_rmid_allocator(&bench_allocator);
+    free_percpu(bench_stats);
+    pr_info(BENCH_PREFIX "benchmark complete\n");
+}
+
+module_init(rmid_bench_init);
+module_exit(rmid_bench_exit);
@@ -0,0 +1,261 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/fs.h>
+#include <linux/poll.h>
+#include <linux/uaccess.h>
+#include <linux/percpu.h>
+#include <linux/cpumask.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+
+#include "sample_ring.h"
+#include "collector.h"
+
+/*
+ * Ring memory layout: one vmalloc_user() allocation per CPU, starting with
+ * struct sample_ring_header padded to a full page, followed by the record
+ * array. vmalloc_user gives zeroed pages that are safe to map to userspace,
+ * and remap_vmalloc_range() enforces that the mapping covers only this
+ * allocation.
+ */
+
+static u64 ring_region_bytes(u32 num_records)
+{
+    return PAGE_ALIGN(PAGE_SIZE + (u64)num_records * sizeof(struct sample_record));
+}
+
+/* Deferred from sample_ring_emit: wake pollers outside the emit context,
+ * which may be a timer IRQ or the inside of a context switch where taking
+ * the waitqueue lock directly could recurse into the scheduler. */
+static void sample_ring_wakeup_fn(struct irq_work *work)
+{
+    struct sample_ring *ring = container_of(work, struct sample_ring, wakeup);
+
+    wake_up_interruptible(&ring->set->waitq);
+}
+
+void sample_ring_emit(struct sample_ring_set *set, const struct sample_record *rec)
+{
+    struct sample_ring *ring;
+    struct sample_ring_header *hdr;
+    u64 prod, cons;
+    unsigned long flags;
+
+    local_irq_save(flags);
+    ring = this_cpu_ptr(set->rings);
+    hdr = ring->hdr;
+
+    prod = hdr->producer;
+    cons = READ_ONCE(hdr->consumer);
+
+    if (prod - cons >= set->num_records) {
+        // Full: drop and account. The consumer detects loss from the gap
+        // between its own count and producer - dropped.
+        WRITE_ONCE(hdr->dropped, hdr->dropped + 1);
+        local_irq_restore(flags);
+        return;
+    }
+
+    ring->records[prod & (set->num_records - 1)] = *rec;
+    ring->records[prod & (set->num_records - 1)].cpu = smp_processor_id();
+
+    // Publish the record before the index that covers it; the userspace
+    // consumer pairs this with an acquire load of producer
+    smp_store_release(&hdr->producer, prod + 1);
+
+    if (prod + 1 - cons == set->watermark)
+        irq_work_queue(&ring->wakeup);
+
+    local_irq_restore(flags);
+}
+
+static struct sample_ring_set *file_ring_set(struct file *file)
+{
+    // misc_open() points private_data at the miscdevice
+    return container_of(file->private_data, struct sample_ring_set, dev);
+}
+
+static __poll_t sample_ring_poll(struct file *file, poll_table *wait)
+{
+    struct sample_ring_set *set = file_ring_set(file);
+    int cpu;
+
+    poll_wait(file, &set->waitq, wait);
+
+    for_each_possible_cpu(cpu) {
+        struct sample_ring_header *hdr = per_cpu_ptr(set->rings, cpu)->hdr;
+
+        if (smp_load_acquire(&hdr->producer) - READ_ONCE(hdr->consumer) >= set->watermark)
+            return EPOLLIN | EPOLLRDNORM;
+    }
+
+    return 0;
+}
+
+static int sample_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+    struct sample_ring_set *set = file_ring_set(file);
+    u64 offset = (u64)vma->vm_pgoff << PAGE_SHIFT;
+    u64 size = vma->vm_end - vma->vm_start;
+    unsigned int cpu;
+
+    // The shared memory is strictly kernel-to-user: refuse writable mappings
+    // so a consumer cannot corrupt producer state
+    if (vma->vm_flags & VM_WRITE)
+        return -EPERM;
+    vm_flags_clear(vma, VM_MAYWRITE);
+
+    // Each mapping covers exactly one CPU's region, selected by offset
+    if (size != set->ring_bytes || offset % set->ring_bytes)
+        return -EINVAL;
+    cpu = div64_u64(offset, set->ring_bytes);
+    if (cpu >= nr_cpu_ids || !cpu_possible(cpu))
+        return -EINVAL;
+
+    return remap_vmalloc_range(vma, per_cpu_ptr(set->rings, cpu)->hdr, 0);
+}
+
+static long sample_ring_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    struct sample_ring_set *set = file_ring_set(file);
+
+    switch (cmd) {
+    case SAMPLE_RING_IOC_GET_LAYOUT: {
+        struct sample_ring_layout layout = {
+            .nr_cpus = nr_cpu_ids,
+            .record_size = sizeof(struct sample_record),
+            .num_records = set->num_records,
+            .watermark = set->watermark,
+            .ring_bytes = set->ring_bytes,
+        };
+
+        if (copy_to_user((void __user *)arg, &layout, sizeof(layout)))
+            return -EFAULT;
+        return 0;
+    }
+    case SAMPLE_RING_IOC_CONSUME: {
+        struct sample_ring_consume req;
+        struct sample_ring_header *hdr;
+
+        if (copy_from_user(&req, (void __user *)arg, sizeof(req)))
+            return -EFAULT;
+        if (req.cpu >= nr_cpu_ids || !cpu_possible(req.cpu))
+            return -EINVAL;
+
+        hdr = per_cpu_ptr(set->rings, req.cpu)->hdr;
+
+        // The consumer index may only move forward, and never past the
+        // producer. producer is read without synchronization against the
+        // remote producer, but it only grows, so the check is conservative.
+        if (req.consumer < READ_ONCE(hdr->consumer) ||
+            req.consumer > READ_ONCE(hdr->producer))
+            return -EINVAL;
+
+        WRITE_ONCE(hdr->consumer, req.consumer);
+        return 0;
+    }
+    default:
+        return -ENOTTY;
+    }
+}
+
+static const struct file_operations sample_ring_fops = {
+    .owner = THIS_MODULE,
+    .poll = sample_ring_poll,
+    .mmap = sample_ring_mmap,
+    .unlocked_ioctl = sample_ring_ioctl,
+};
+
+static void free_ring_memory(struct sample_ring_set *set)
+{
+    int cpu;
+
+    for_each_possible_cpu(cpu) {
+        struct sample_ring *ring = per_cpu_ptr(set->rings, cpu);
+
+        vfree(ring->hdr);
+        ring->hdr = NULL;
+        ring->records = NULL;
+    }
+}
+
+int sample_ring_init(struct sample_ring_set *set, const char *name,
+                     u32 num_records, u32 watermark)
+{
+    int cpu;
+    int ret;
+
+    if (!set || !name || !is_power_of_2(num_records))
+        return -EINVAL;
+
+    memset(set, 0, sizeof(*set));
+    set->num_records = num_records;
+    set->watermark = clamp(watermark, 1u, num_records);
+    set->ring_bytes = ring_region_bytes(num_records);
+    init_waitqueue_head(&set->waitq);
+
+    set->rings = alloc_percpu(struct sample_ring);
+    if (!set->rings) {
+        pr_err(LOG_PREFIX "Failed to allocate per-CPU sample rings\n");
+        return -ENOMEM;
+    }
+
+    for_each_possible_cpu(cpu) {
+        struct sample_ring *ring = per_cpu_ptr(set->rings, cpu);
+
+        ring->hdr = vmalloc_user(set->ring_bytes);
+        if (!ring->hdr) {
+            pr_err(LOG_PREFIX "Failed to allocate sample ring for CPU %d\n", cpu);
+            ret = -ENOMEM;
+            goto err_free_memory;
+        }
+        ring->records = (struct sample_record *)((char *)ring->hdr + PAGE_SIZE);
+        ring->hdr->record_size = sizeof(struct sample_record);
+        ring->hdr->num_records = num_records;
+        ring->set = set;
+        init_irq_work(&ring->wakeup, sample_ring_wakeup_fn);
+    }
+
+    set->dev.minor = MISC_DYNAMIC_MINOR;
+    set->dev.name = name;
+    set->dev.fops = &sample_ring_fops;
+    ret = misc_register(&set->dev);
+    if (ret) {
+        pr_err(LOG_PREFIX "Failed to register sample ring device %s: %d\n", name, ret);
+        goto err_free_memory;
+    }
+    set->dev_registered = true;
+
+    return 0;
+
+err_free_memory:
+    free_ring_memory(set);
+    free_percpu(set->rings);
+    set->rings = NULL;
+    return ret;
+}
+
+void sample_ring_cleanup(struct sample_ring_set *set)
+{
+    int cpu;
+
+    if (!set || !set->rings)
+        return;
+
+    if (set->dev_registered) {
+        misc_deregister(&set->dev);
+        set->dev_registered = false;
+    }
+
+    // Producers are gone (caller's responsibility); flush any wakeup that
+    // is still in flight before freeing the rings it points into
+    for_each_possible_cpu(cpu)
+        irq_work_sync(&per_cpu_ptr(set->rings, cpu)->wakeup);
+
+    free_ring_memory(set);
+    free_percpu(set->rings);
+    set->rings = NULL;
+}
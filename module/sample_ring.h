@@ -0,0 +1,137 @@
+#ifndef _SAMPLE_RING_H
+#define _SAMPLE_RING_H
+
+#include <linux/types.h>
+#include <linux/wait.h>
+#include <linux/irq_work.h>
+#include <linux/miscdevice.h>
+
+/*
+ * Per-CPU single-producer sample rings, exported to userspace through an
+ * mmap-able character device.
+ *
+ * Each CPU owns one ring of fixed-size binary records. The producer (that
+ * CPU's timer tick and sched_switch paths) writes a record and publishes it
+ * with a single release store of the producer index — no locks, no trace
+ * machinery. Userspace maps every ring read-only, consumes records directly
+ * from the shared memory, and acknowledges them by advancing the consumer
+ * index through an ioctl. Wakeups are batched: the producer raises the
+ * device's poll/epoll readiness only when a ring crosses the configured
+ * watermark of unconsumed records, so a reader can sleep in epoll_wait()
+ * instead of polling every ring every tick.
+ */
+
+/* Layout of the userspace ABI: each CPU's region starts with this header
+ * (padded to a page), followed by num_records records of record_size bytes.
+ * CPU c's region is mapped at file offset c * ring_bytes. */
+struct sample_ring_header {
+    __u64 producer;   /* Free-running record count, written by the kernel */
+    __u64 consumer;   /* Advanced by userspace via SAMPLE_RING_IOC_CONSUME */
+    __u64 dropped;    /* Records discarded because the ring was full */
+    __u32 record_size;
+    __u32 num_records;  /* Power of two; slot = index & (num_records - 1) */
+};
+
+/* Record types */
+#define SAMPLE_RECORD_TYPE_PERF 1  /* One task measurement trigger on a CPU */
+#define SAMPLE_RECORD_TYPE_RDT  2  /* One RMID's RDT counter readings */
+
+/* Flags for SAMPLE_RECORD_TYPE_PERF records */
+#define SAMPLE_RECORD_FLAG_CONTEXT_SWITCH (1 << 0)
+
+/* Fixed 64-byte record. PERF records carry rmid and flags; RDT records carry
+ * rmid plus the three counter readings with their per-event error codes
+ * (mirroring struct rdt_sample). */
+struct sample_record {
+    __u32 type;
+    __u32 cpu;
+    __u64 timestamp;
+    __u32 rmid;
+    __u32 flags;
+    __u64 llc_occupancy;
+    __u64 mbm_total;
+    __u64 mbm_local;
+    __s32 llc_occupancy_err;
+    __s32 mbm_total_err;
+    __s32 mbm_local_err;
+    __u32 reserved;
+};
+
+/* Overall geometry of the device, for sizing mmaps */
+struct sample_ring_layout {
+    __u32 nr_cpus;      /* Number of per-CPU rings (nr_cpu_ids) */
+    __u32 record_size;
+    __u32 num_records;
+    __u32 watermark;
+    __u64 ring_bytes;   /* Per-CPU region size, page aligned */
+};
+
+/* Acknowledge consumption of one CPU's records up to a new consumer index */
+struct sample_ring_consume {
+    __u32 cpu;
+    __u32 reserved;
+    __u64 consumer;
+};
+
+#define SAMPLE_RING_IOC_MAGIC 'u'
+#define SAMPLE_RING_IOC_GET_LAYOUT _IOR(SAMPLE_RING_IOC_MAGIC, 1, struct sample_ring_layout)
+#define SAMPLE_RING_IOC_CONSUME    _IOW(SAMPLE_RING_IOC_MAGIC, 2, struct sample_ring_consume)
+
+/* One CPU's ring (kernel-side bookkeeping) */
+struct sample_ring {
+    struct sample_ring_header *hdr;   /* Start of the vmalloc_user region */
+    struct sample_record *records;    /* hdr + one page */
+    struct irq_work wakeup;           /* Defers the poll wakeup out of the
+                                         emit context (timer IRQ or inside
+                                         the scheduler) */
+    struct sample_ring_set *set;
+};
+
+/* A set of per-CPU rings behind one character device */
+struct sample_ring_set {
+    struct sample_ring __percpu *rings;
+    u32 num_records;    /* Per ring; power of two */
+    u32 watermark;      /* Unconsumed records that trigger a wakeup */
+    u64 ring_bytes;     /* Per-CPU region size, page aligned */
+    wait_queue_head_t waitq;
+    struct miscdevice dev;
+    bool dev_registered;
+};
+
+/**
+ * sample_ring_init - Allocate the per-CPU rings and register the device
+ * @set: Uninitialized ring set structure to populate
+ * @name: Device name under /dev
+ * @num_records: Ring capacity per CPU; must be a power of two
+ * @watermark: Unconsumed-record count at which the producer wakes pollers;
+ *             clamped to [1, num_records]
+ *
+ * Return: 0 on success, negative error code on failure
+ */
+int sample_ring_init(struct sample_ring_set *set, const char *name,
+                     u32 num_records, u32 watermark);
+
+/**
+ * sample_ring_cleanup - Unregister the device and free the rings
+ * @set: Ring set structure to clean up
+ *
+ * The caller must ensure no producer can call sample_ring_emit() once this
+ * runs (timers cancelled, tracepoint probes unregistered and synchronized).
+ */
+void sample_ring_cleanup(struct sample_ring_set *set);
+
+/**
+ * sample_ring_emit - Append a record to the current CPU's ring
+ * @set: Ring set
+ * @rec: Record to copy in; rec->cpu is filled in by this function
+ *
+ * The fast path is one bounds check, one 64-byte copy, and one release
+ * store of the producer index. When the ring is full the record is dropped
+ * and the header's drop counter incremented; the consumer sees the gap in
+ * the counter. Disables IRQs briefly so the tick path cannot interleave
+ * with a sched_switch emit on the same CPU — each ring has exactly one
+ * producer at a time.
+ */
+void sample_ring_emit(struct sample_ring_set *set, const struct sample_record *rec);
+
+#endif /* _SAMPLE_RING_H */
@@ -0,0 +1,177 @@
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/percpu.h>
+#include "sample_ring.h"
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Memory Collector Project");
+MODULE_DESCRIPTION("Test module for per-CPU sample rings");
+MODULE_VERSION("1.0");
+
+#define TEST_PREFIX "sample_ring_test: "
+#define TEST_RESULT "test_result:"
+#define TEST_DEV_NAME "sample_ring_test"
+#define TEST_NUM_RECORDS 8
+
+static struct sample_ring_set test_set;
+
+
+static bool test_init_validation(void)
+{
+    struct sample_ring_set bad_set;
+    bool passed = true;
+    int ret;
+
+    ret = sample_ring_init(NULL, TEST_DEV_NAME, TEST_NUM_RECORDS, 1);
+    if (ret != -EINVAL) {
+        pr_err(TEST_PREFIX "init with NULL set should return -EINVAL, got %d\n", ret);
+        passed = false;
+    }
+
+    // Capacity must be a power of two for the index mask to work
+    ret = sample_ring_init(&bad_set, TEST_DEV_NAME, 6, 1);
+    if (ret != -EINVAL) {
+        pr_err(TEST_PREFIX "init with non-power-of-two capacity should return -EINVAL, got %d\n", ret);
+        passed = false;
+    }
+
+    ret = sample_ring_init(&test_set, TEST_DEV_NAME, TEST_NUM_RECORDS, 2);
+    if (ret != 0) {
+        pr_err(TEST_PREFIX "init with valid arguments failed: %d\n", ret);
+        passed = false;
+    }
+
+    pr_info(TEST_RESULT "sample_ring_init:%s\n", passed ? "pass" : "fail");
+    return passed;
+}
+
+static bool test_emit_and_layout(void)
+{
+    struct sample_ring_header *hdr;
+    struct sample_record rec = {
+        .type = SAMPLE_RECORD_TYPE_PERF,
+        .timestamp = 1234,
+        .rmid = 7,
+        .flags = SAMPLE_RECORD_FLAG_CONTEXT_SWITCH,
+    };
+    struct sample_record *stored;
+    bool passed = true;
+
+    // Pin to one CPU so the emits and the assertions see the same ring
+    get_cpu();
+    hdr = this_cpu_ptr(test_set.rings)->hdr;
+
+    if (hdr->record_size != sizeof(struct sample_record) ||
+        hdr->num_records != TEST_NUM_RECORDS) {
+        pr_err(TEST_PREFIX "header geometry wrong: record_size=%u num_records=%u\n",
+               hdr->record_size, hdr->num_records);
+        passed = false;
+    }
+
+    sample_ring_emit(&test_set, &rec);
+
+    if (hdr->producer != 1) {
+        pr_err(TEST_PREFIX "producer should be 1 after first emit, got %llu\n",
+               hdr->producer);
+        passed = false;
+    }
+
+    stored = (struct sample_record *)((char *)hdr + PAGE_SIZE);
+    if (stored->type != SAMPLE_RECORD_TYPE_PERF || stored->timestamp != 1234 ||
+        stored->rmid != 7 || stored->flags != SAMPLE_RECORD_FLAG_CONTEXT_SWITCH) {
+        pr_err(TEST_PREFIX "stored record does not match emitted record\n");
+        passed = false;
+    }
+    put_cpu();
+
+    pr_info(TEST_RESULT "sample_ring_emit:%s\n", passed ? "pass" : "fail");
+    return passed;
+}
+
+static bool test_full_ring_drops(void)
+{
+    struct sample_ring_header *hdr;
+    struct sample_record rec = { .type = SAMPLE_RECORD_TYPE_RDT };
+    u64 start;
+    bool passed = true;
+    int i;
+
+    // Pin to one CPU for the fill-and-overflow sequence
+    get_cpu();
+    hdr = this_cpu_ptr(test_set.rings)->hdr;
+    start = hdr->producer;
+
+    // Fill the remaining capacity and then overflow by 3
+    for (i = 0; i < TEST_NUM_RECORDS + 3; i++)
+        sample_ring_emit(&test_set, &rec);
+
+    if (hdr->producer - hdr->consumer != TEST_NUM_RECORDS) {
+        pr_err(TEST_PREFIX "producer should stop at capacity %d ahead, got %llu\n",
+               TEST_NUM_RECORDS, hdr->producer - hdr->consumer);
+        passed = false;
+    }
+    // Everything past the free capacity at the start must have been dropped
+    if (hdr->dropped != (start - hdr->consumer) + 3) {
+        pr_err(TEST_PREFIX "expected %llu dropped records, got %llu\n",
+               (start - hdr->consumer) + 3, hdr->dropped);
+        passed = false;
+    }
+
+    // Consuming makes room again
+    start = hdr->producer;
+    WRITE_ONCE(hdr->consumer, hdr->producer);
+    sample_ring_emit(&test_set, &rec);
+    if (hdr->producer != start + 1) {
+        pr_err(TEST_PREFIX "emit after consume should succeed, producer=%llu\n",
+               hdr->producer);
+        passed = false;
+    }
+    put_cpu();
+
+    pr_info(TEST_RESULT "sample_ring_full:%s\n", passed ? "pass" : "fail");
+    return passed;
+}
+
+static bool test_cleanup(void)
+{
+    bool passed = true;
+
+    sample_ring_cleanup(NULL);  // Should not crash
+    sample_ring_cleanup(&test_set);
+    if (test_set.rings != NULL) {
+        pr_err(TEST_PREFIX "rings not nulled after cleanup\n");
+        passed = false;
+    }
+    sample_ring_cleanup(&test_set);  // Double cleanup should be a no-op
+
+    pr_info(TEST_RESULT "sample_ring_cleanup:%s\n", passed ? "pass" : "fail");
+    return passed;
+}
+
+static int __init sample_ring_test_init(void)
+{
+    bool all_passed = true;
+
+    pr_info(TEST_PREFIX "starting tests\n");
+
+    all_passed &= test_init_validation();
+    if (test_set.rings) {
+        all_passed &= test_emit_and_layout();
+        all_passed &= test_full_ring_drops();
+    }
+
+    pr_info(TEST_PREFIX "initialization tests %s\n", all_passed ? "passed" : "failed");
+    return 0;
+}
+
+static void __exit sample_ring_test_exit(void)
+{
+    bool cleanup_passed;
+
+    cleanup_passed = test_cleanup();
+    pr_info(TEST_PREFIX "cleanup tests %s\n", cleanup_passed ? "passed" : "failed");
+}
+
+module_init(sample_ring_test_init);
+module_exit(sample_ring_test_exit);
@@ -8,31 +8,49 @@
 #include "sync_timer.h"
 #include "collector.h"
 
+/* Per-CPU phase offset within the interval */
+static u64 sync_timer_phase_offset(struct sync_timer *timer, int cpu)
+{
+    if (!timer->phase_stagger_ns)
+        return 0;
+    return ((u64)cpu * timer->phase_stagger_ns) % timer->interval_ns;
+}
+
+/* Next expiration: the next interval boundary, shifted by this CPU's phase
+ * offset. Computed relative to (now - offset) so the result is always in
+ * the future. */
+static ktime_t sync_timer_next_expiry(struct sync_timer *timer, ktime_t now, int cpu)
+{
+    u64 offset = sync_timer_phase_offset(timer, cpu);
+    u64 base = ktime_to_ns(now) - offset;
+
+    base += timer->interval_ns;
+    base -= base % timer->interval_ns;
+    return ns_to_ktime(base + offset);
+}
+
 /* Structure for CPU timer initialization */
 struct timer_init_data {
     struct work_struct work;
     struct sync_timer *timer;
 };
 
-/* Internal function to initialize timer on a specific CPU */
-static void init_cpu_timer(struct work_struct *work)
+/* Initialize and start the current CPU's timer; must run on that CPU */
+static void sync_timer_start_current(struct sync_timer *timer)
 {
-    struct timer_init_data *init_data = container_of(work, struct timer_init_data, work);
-    struct sync_timer *timer = init_data->timer;
     struct sync_timer_cpu *cpu_timer;
     ktime_t now;
     int cpu = smp_processor_id();
 
     cpu_timer = per_cpu_ptr(timer->cpu_timers, cpu);
-    
+
     /* Initialize HR timer */
     hrtimer_init(&cpu_timer->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS_PINNED);
     cpu_timer->timer.function = timer->timer_fn;
 
-    /* Calculate next interval boundary */
+    /* Calculate next interval boundary (plus this CPU's phase offset) */
     now = ktime_get();
-    cpu_timer->next_expected = ktime_add_ns(now, timer->interval_ns);
-    cpu_timer->next_expected = ktime_sub_ns(cpu_timer->next_expected, ktime_to_ns(cpu_timer->next_expected) % timer->interval_ns);
+    cpu_timer->next_expected = sync_timer_next_expiry(timer, now, cpu);
 
     pr_debug(LOG_PREFIX "Initializing timer on CPU %d, interval: %llu ns, now: %lld ns, next_expected: %lld ns\n", cpu, timer->interval_ns, ktime_to_ns(now), ktime_to_ns(cpu_timer->next_expected));
 
@@ -40,9 +58,38 @@ static void init_cpu_timer(struct work_struct *work)
     hrtimer_start(&cpu_timer->timer, cpu_timer->next_expected, HRTIMER_MODE_ABS_PINNED);
 }
 
+/* Internal function to initialize timer on a specific CPU */
+static void init_cpu_timer(struct work_struct *work)
+{
+    struct timer_init_data *init_data = container_of(work, struct timer_init_data, work);
+
+    sync_timer_start_current(init_data->timer);
+}
+
+int sync_timer_online_cpu(struct sync_timer *timer)
+{
+    if (!timer || !timer->initialized)
+        return -EINVAL;
+
+    sync_timer_start_current(timer);
+    return 0;
+}
+
+void sync_timer_offline_cpu(struct sync_timer *timer)
+{
+    struct sync_timer_cpu *cpu_timer;
+
+    if (!timer || !timer->initialized)
+        return;
+
+    cpu_timer = per_cpu_ptr(timer->cpu_timers, smp_processor_id());
+    hrtimer_cancel(&cpu_timer->timer);
+}
+
 int sync_timer_init(struct sync_timer *timer,
                    enum hrtimer_restart (*timer_fn)(struct hrtimer *),
-                   u64 interval_ns)
+                   u64 interval_ns,
+                   u64 phase_stagger_ns)
 {
     int ret = -EINVAL;
     int cpu;
@@ -55,6 +102,7 @@ int sync_timer_init(struct sync_timer *timer,
     /* Initialize timer structure */
     timer->timer_fn = timer_fn;
     timer->interval_ns = interval_ns;
+    timer->phase_stagger_ns = phase_stagger_ns;
     timer->initialized = false;
 
     /* Allocate per-CPU timer structures */
@@ -137,9 +185,8 @@ enum hrtimer_restart sync_timer_restart(struct hrtimer *timer,
     cpu_timer = container_of(timer, struct sync_timer_cpu, timer);
     now = ktime_get();
 
-    /* Calculate next interval boundary */
-    cpu_timer->next_expected = ktime_add_ns(now, timer_data->interval_ns);
-    cpu_timer->next_expected = ktime_sub_ns(cpu_timer->next_expected, ktime_to_ns(cpu_timer->next_expected) % timer_data->interval_ns);
+    /* Calculate next interval boundary (plus this CPU's phase offset) */
+    cpu_timer->next_expected = sync_timer_next_expiry(timer_data, now, smp_processor_id());
 
     /* Set next expiration time */
     hrtimer_set_expires(timer, cpu_timer->next_expected);
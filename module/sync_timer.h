@@ -15,6 +15,7 @@ struct sync_timer {
     struct sync_timer_cpu __percpu *cpu_timers;  /* Per-CPU timers */
     enum hrtimer_restart (*timer_fn)(struct hrtimer *);  /* Timer callback */
     u64 interval_ns;              /* Timer interval in nanoseconds */
+    u64 phase_stagger_ns;         /* Per-CPU phase offset step in nanoseconds */
     bool initialized;             /* Initialization state */
 };
 
@@ -23,16 +24,24 @@ struct sync_timer {
  * @timer: Uninitialized timer structure to populate
  * @timer_fn: Callback function to run on timer expiration
  * @interval_ns: Timer interval in nanoseconds
+ * @phase_stagger_ns: Per-CPU phase offset step in nanoseconds (0 = none)
  *
  * Initializes high-resolution timers on all CPUs that trigger
  * synchronously at interval boundaries. After return, all timers
  * are active and will trigger at the next interval boundary.
  *
+ * A non-zero @phase_stagger_ns offsets each CPU's expiration by
+ * (cpu * phase_stagger_ns) % interval_ns past the boundary, spreading the
+ * per-interval work burst across the interval instead of firing every CPU
+ * in the same microsecond. Consumers that assemble per-interval data must
+ * subtract the same offsets when mapping timestamps to intervals.
+ *
  * Return: 0 on success, negative error code on failure
  */
 int sync_timer_init(struct sync_timer *timer, 
                    enum hrtimer_restart (*timer_fn)(struct hrtimer *),
-                   u64 interval_ns);
+                   u64 interval_ns,
+                   u64 phase_stagger_ns);
 
 /**
  * sync_timer_destroy - Clean up and cancel all timers
@@ -44,6 +53,28 @@ int sync_timer_init(struct sync_timer *timer,
  */
 void sync_timer_destroy(struct sync_timer *timer);
 
+/**
+ * sync_timer_online_cpu - Start the timer on a CPU that came online
+ * @timer: Initialized timer structure
+ *
+ * Initializes and starts the calling CPU's timer, aligned to the same
+ * interval boundaries (and phase offset) as the other CPUs. Intended to be
+ * called from a CPU hotplug online callback, which runs on the incoming
+ * CPU; must not be called before sync_timer_init() completed.
+ *
+ * Return: 0 on success, -EINVAL if the timer is not initialized
+ */
+int sync_timer_online_cpu(struct sync_timer *timer);
+
+/**
+ * sync_timer_offline_cpu - Stop the timer on a CPU that is going offline
+ * @timer: Initialized timer structure
+ *
+ * Cancels the calling CPU's timer. Intended to be called from a CPU
+ * hotplug offline callback, which runs on the outgoing CPU.
+ */
+void sync_timer_offline_cpu(struct sync_timer *timer);
+
 /**
  * sync_timer_restart - Reset timer to next interval boundary
  * @timer: HR timer that expired
@@ -218,7 +218,7 @@ static int __init sync_timer_bench_init(void)
     }
 
     /* Initialize timer */
-    ret = sync_timer_init(&bench_timer, bench_timer_fn, BENCH_INTERVAL_NS);
+    ret = sync_timer_init(&bench_timer, bench_timer_fn, BENCH_INTERVAL_NS, 0);
     if (ret) {
         pr_err(BENCH_PREFIX "Failed to initialize timer: %d\n", ret);
         free_percpu(cpu_stats);
@@ -98,7 +98,7 @@ static bool test_timer_init(void)
         tick_data->last_tick = div64_u64(ktime_get_ns(), TEST_INTERVAL_NS);
     }
 
-    ret = sync_timer_init(&test_timer, test_timer_fn, TEST_INTERVAL_NS);
+    ret = sync_timer_init(&test_timer, test_timer_fn, TEST_INTERVAL_NS, 0);
     if (ret) {
         free_percpu(cpu_ticks);
         report_test_result("timer_init", false, "init failed");
@@ -147,7 +147,7 @@ static bool test_timer_cleanup(void)
     }
 
     /* Initialize timer */
-    ret = sync_timer_init(&test_timer, test_timer_fn, TEST_INTERVAL_NS);
+    ret = sync_timer_init(&test_timer, test_timer_fn, TEST_INTERVAL_NS, 0);
     if (ret) {
         free_percpu(cpu_ticks);
         report_test_result("timer_cleanup", false, "init failed");
@@ -1,6 +1,10 @@
 #ifndef __RMID_ALLOCATOR_BPF_H
 #define __RMID_ALLOCATOR_BPF_H
 
+// Default dimension of the backing maps. This is only the compile-time
+// default: userspace should resize both maps before load to the RMID count
+// enumerated from hardware (MapSpec.MaxEntries with cilium/ebpf), so small
+// machines pay for 64 entries and large AMD parts get several thousand.
 #define MAX_RMIDS 1024
 #define TASK_COMM_LEN 16
 
@@ -10,14 +14,34 @@ struct rmid_free_entry {
     __u64 free_timestamp;
 };
 
-// Allocator state structure
+// Allocation bitmap: rmid -> allocated flag. Array maps are zero-filled by
+// the kernel, so a fresh map means "nothing allocated" with no init loop.
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, MAX_RMIDS);
+    __type(key, __u32);
+    __type(value, __u8);
+} rmid_allocated SEC(".maps");
+
+// Free list circular buffer, indexed by free_head/free_tail modulo
+// num_rmids. Entries are initialized lazily: RMID 0 is never stored in the
+// free list, so a zero entry means the slot was never written and still
+// holds its implicit initial content {rmid = slot index, free_timestamp = 0}
+// — the same state the old eager init loop produced.
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, MAX_RMIDS);
+    __type(key, __u32);
+    __type(value, struct rmid_free_entry);
+} rmid_free_list SEC(".maps");
+
+// Allocator state structure: scalars only, the per-RMID storage lives in
+// the maps above so its size is set at load time
 struct rmid_allocator {
     __u32 num_rmids;         // Number of RMIDs to allocate (1-based)
     __u64 min_free_time_ns;  // Minimum time before RMID reuse
     __u64 free_head;         // Growing index of head in free circular buffer
     __u64 free_tail;         // Growing index of tail in free circular buffer
-    __u8 is_allocated[MAX_RMIDS];
-    struct rmid_free_entry free_list[MAX_RMIDS];
 };
 
 // Helper function to check if an RMID is valid
@@ -27,88 +51,120 @@ static __always_inline __u32 rmid_is_valid(struct rmid_allocator *allocator, __u
 
 // Helper function to check if an RMID is allocated
 static __always_inline __u8 rmid_is_allocated(struct rmid_allocator *allocator, __u32 rmid) {
+    __u8 *allocated;
+
     if (!allocator)
         return 0;
-        
-    if (rmid >= MAX_RMIDS)
+
+    if (!rmid_is_valid(allocator, rmid))
         return 0;
-        
-    return allocator->is_allocated[rmid];
+
+    allocated = bpf_map_lookup_elem(&rmid_allocated, &rmid);
+    if (!allocated)
+        return 0;
+
+    return *allocated;
 }
 
-// Function to initialize the allocator
+// Function to initialize the allocator. O(1): the backing maps start
+// zero-filled and free list entries materialize on first touch, so there is
+// no loop over the RMID space. Assumes freshly loaded (zeroed) maps.
 static __always_inline __u8 rmid_init(struct rmid_allocator *allocator, __u32 num_rmids, __u64 min_free_time_ns) {
+    __u32 last;
+
     if (!allocator)
         return 0;
-        
-    // Validate num_rmids is within bounds
-    if (num_rmids == 0 || num_rmids > MAX_RMIDS)
+
+    if (num_rmids == 0)
+        return 0;
+
+    // Validate that the maps were dimensioned to cover the RMID space: the
+    // highest slot must exist in both
+    last = num_rmids - 1;
+    if (!bpf_map_lookup_elem(&rmid_allocated, &last))
+        return 0;
+    if (!bpf_map_lookup_elem(&rmid_free_list, &last))
         return 0;
-        
+
     allocator->num_rmids = num_rmids;
     allocator->min_free_time_ns = min_free_time_ns;
     allocator->free_head = 1;
     allocator->free_tail = num_rmids;
-    
-    // Initialize free list with all RMIDs
-    for (__u32 i = 0; i < MAX_RMIDS; i++) {
-        allocator->free_list[i].rmid = i;
-        allocator->free_list[i].free_timestamp = 0;
-    }
-    
+
     return 1;
 }
 
 // Function to allocate an RMID
 static __always_inline __u32 rmid_alloc(struct rmid_allocator *allocator, __u64 timestamp) {
+    struct rmid_free_entry *entry;
+    __u64 free_timestamp;
+    __u32 slot;
+    __u32 rmid;
+    __u8 *allocated;
+
     if (!allocator)
         return 0;
-        
-    __u32 rmid;
-    
+
+    if (allocator->num_rmids == 0)
+        return 0;
+
     // Check if there are any free RMIDs by comparing head and tail
     if (allocator->free_head == allocator->free_tail)
         return 0;
-        
+
     // Get next free RMID from circular buffer
-    struct rmid_free_entry *entry = &allocator->free_list[allocator->free_head % MAX_RMIDS];
-    
+    slot = allocator->free_head % allocator->num_rmids;
+    entry = bpf_map_lookup_elem(&rmid_free_list, &slot);
+    if (!entry)
+        return 0;
+
+    // Lazy first-touch: a zero entry still holds its implicit initial
+    // content, RMID == slot index freed at time 0
+    rmid = entry->rmid ? entry->rmid : slot;
+    free_timestamp = entry->rmid ? entry->free_timestamp : 0;
+
     // Check if enough time has passed since this RMID was freed
-    if (timestamp - entry->free_timestamp < allocator->min_free_time_ns)
+    if (timestamp - free_timestamp < allocator->min_free_time_ns)
         return 0;
-        
-    rmid = entry->rmid;
-    if (rmid > MAX_RMIDS)
+
+    allocated = bpf_map_lookup_elem(&rmid_allocated, &rmid);
+    if (!allocated)
         return 0;
-    
+
     // Update free head (let it grow)
     allocator->free_head++;
-    
+
     // Mark as allocated
-    allocator->is_allocated[rmid] = 1;
-    
+    *allocated = 1;
+
     return rmid;
 }
 
 // Function to free an RMID
 static __always_inline __s64 rmid_free(struct rmid_allocator *allocator, __u32 rmid, __u64 timestamp) {
+    struct rmid_free_entry *entry;
+    __u32 slot;
+    __u8 *allocated;
+
     if (!allocator)
         return -1;
-        
+
     if (!rmid_is_valid(allocator, rmid))
         return -1;
 
-    if (!rmid_is_allocated(allocator, rmid))
+    allocated = bpf_map_lookup_elem(&rmid_allocated, &rmid);
+    if (!allocated || !*allocated)
         return -1;
 
-    if (rmid >= MAX_RMIDS)
+    slot = allocator->free_tail % allocator->num_rmids;
+    entry = bpf_map_lookup_elem(&rmid_free_list, &slot);
+    if (!entry)
         return -1;
 
     // Mark as free
-    allocator->is_allocated[rmid] = 0;
-    
+    *allocated = 0;
+
     // Add to free list
-    struct rmid_free_entry *entry = &allocator->free_list[allocator->free_tail % MAX_RMIDS];
     entry->rmid = rmid;
     entry->free_timestamp = timestamp;
     allocator->free_tail++;
@@ -116,4 +172,4 @@ static __always_inline __s64 rmid_free(struct rmid_allocator *allocator, __u32 r
     return 0;
 }
 
-#endif /* __RMID_ALLOCATOR_BPF_H */ 
\ No newline at end of file
+#endif /* __RMID_ALLOCATOR_BPF_H */
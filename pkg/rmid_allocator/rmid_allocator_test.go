@@ -348,3 +348,45 @@ func TestInvalidNumRmid(t *testing.T) {
 		t.Errorf("Unexpected error with valid num_rmid: %v", err)
 	}
 }
+
+func TestResizedMaps(t *testing.T) {
+	if err := rlimit.RemoveMemlock(); err != nil {
+		t.Fatalf("Failed to remove memlock limit: %v", err)
+	}
+	// Resize the backing maps before load, the way production code
+	// dimensions them from the enumerated max RMID
+	spec, err := LoadRmidTest()
+	if err != nil {
+		t.Fatalf("Failed to load spec: %v", err)
+	}
+	const resized = 8
+	spec.Maps["rmid_allocated"].MaxEntries = resized
+	spec.Maps["rmid_free_list"].MaxEntries = resized
+
+	objs := RmidTestObjects{}
+	if err := spec.LoadAndAssign(&objs, nil); err != nil {
+		t.Fatalf("Failed to load objects with resized maps: %v", err)
+	}
+	defer objs.Close()
+
+	// Init must fail past the resized dimension and succeed at it
+	if err := RmidInit(&objs, resized+1, 2000000); err == nil {
+		t.Error("Expected error when num_rmid exceeds resized map size")
+	}
+	if err := RmidInit(&objs, resized, 2000000); err != nil {
+		t.Fatalf("Unexpected error with num_rmid equal to resized map size: %v", err)
+	}
+
+	// Every RMID must be allocatable straight after the O(1) init, proving
+	// the lazy first-touch free list covers the whole space
+	now := uint64(time.Now().UnixNano())
+	for i := 1; i < resized; i++ {
+		rmid, err := RmidAlloc(&objs, now)
+		if err != nil {
+			t.Fatalf("Failed to allocate RMID %d: %v", i, err)
+		}
+		if rmid != uint32(i) {
+			t.Errorf("Expected RMID %d, got %d", i, rmid)
+		}
+	}
+}
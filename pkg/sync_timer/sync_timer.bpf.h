@@ -8,6 +8,22 @@
 
 #define NSEC_PER_MSEC 1000000ULL
 
+/* Tick cadence, set by the loader before load. sync_timer_interval_ns is
+ * the tick interval; sync_timer_phase_stagger_ns offsets CPU n's expiration
+ * by (n * stagger) % interval past the boundary, spreading the per-tick
+ * work burst across the interval instead of firing every CPU in the same
+ * microsecond. */
+const volatile __u64 sync_timer_interval_ns = NSEC_PER_MSEC;
+const volatile __u64 sync_timer_phase_stagger_ns = 0;
+
+/* This CPU's phase offset within the interval */
+static __always_inline __u64 __sync_timer_phase_offset(void) {
+    if (!sync_timer_phase_stagger_ns)
+        return 0;
+    return ((__u64)bpf_get_smp_processor_id() * sync_timer_phase_stagger_ns)
+           % sync_timer_interval_ns;
+}
+
 /* Common structures and helper functions */
 struct sync_timer_state {
     struct bpf_timer timer;
@@ -33,7 +49,8 @@ static __always_inline int __sync_timer_shared_callback(
     void (*callback_func)(void)
 ) {
     __u64 now = bpf_ktime_get_ns();
-    __u64 expected_tick = now / NSEC_PER_MSEC;
+    __u64 offset = __sync_timer_phase_offset();
+    __u64 expected_tick = (now - offset) / sync_timer_interval_ns;
     __u64 actual_tick = state->last_tick + 1;
     __u64 delta;
 
@@ -49,10 +66,12 @@ static __always_inline int __sync_timer_shared_callback(
     state->last_tick = actual_tick;
 
     /* Calculate timing delta */
-    delta = __sync_timer_abs_diff(now, actual_tick * NSEC_PER_MSEC);
+    delta = __sync_timer_abs_diff(now, actual_tick * sync_timer_interval_ns + offset);
 
-    /* Calculate next absolute time for timer */
-    state->next_expected = __sync_timer_align_to_interval(now + NSEC_PER_MSEC, NSEC_PER_MSEC);
+    /* Calculate next absolute time for timer: the next interval boundary
+     * after now, shifted by this CPU's phase offset */
+    state->next_expected = __sync_timer_align_to_interval(
+        now - offset + sync_timer_interval_ns, sync_timer_interval_ns) + offset;
 
     /* Reschedule timer for next interval using absolute time */
     bpf_timer_start(&state->timer, state->next_expected, BPF_F_TIMER_ABS | BPF_F_TIMER_CPU_PIN);
@@ -73,28 +92,29 @@ static __always_inline int __sync_timer_shared_init(
     __u8 init_flag = 1;
     __u32 key = 0;
 
-    /* Get timer state for this CPU */
+    /* Timer state lives in an array indexed by CPU id; entries are
+     * preallocated by the kernel */
     state = bpf_map_lookup_elem(timer_states_map, &cpu);
     if (!state) {
-        struct sync_timer_state new_state = {};
-        ret = bpf_map_update_elem(timer_states_map, &cpu, &new_state, BPF_ANY);
-        if (ret < 0) {
-            return ret;
-        }
-        state = bpf_map_lookup_elem(timer_states_map, &cpu);
-        if (!state) {
-            return -1;
-        }
+        return -1;
     }
 
-    /* Initialize timer if not already done */
-    if (bpf_map_lookup_elem(init_status_map, &cpu) == NULL) {
+    /* Initialize timer if not already done. The status map is an array
+     * too, so presence is signalled by the flag value rather than by the
+     * entry existing. */
+    __u8 *initialized = bpf_map_lookup_elem(init_status_map, &cpu);
+    if (!initialized) {
+        return -1;
+    }
+    if (*initialized == 0) {
         now = bpf_ktime_get_ns();
-        state->next_expected = __sync_timer_align_to_interval(now + NSEC_PER_MSEC, NSEC_PER_MSEC);
+        __u64 offset = __sync_timer_phase_offset();
+        state->next_expected = __sync_timer_align_to_interval(
+            now - offset + sync_timer_interval_ns, sync_timer_interval_ns) + offset;
         bpf_timer_init(&state->timer, timer_states_map, CLOCK_MONOTONIC);
         bpf_timer_set_callback(&state->timer, timer_callback);
         bpf_timer_start(&state->timer, state->next_expected, BPF_F_TIMER_ABS | BPF_F_TIMER_CPU_PIN);
-        bpf_map_update_elem(init_status_map, &cpu, &init_flag, BPF_ANY);
+        *initialized = init_flag;
     }
 
     return 0;
@@ -103,17 +123,19 @@ static __always_inline int __sync_timer_shared_init(
 /* Macro to define a complete sync timer implementation */
 #define DEFINE_SYNC_TIMER(timer_name, callback_func) \
 \
-/* Timer state map */ \
+/* Timer state map: an array indexed by CPU id, so the per-tick callback \
+ * does a direct index instead of a hash walk. Sized generously; a loader \
+ * can shrink it to the number of possible CPUs before load. */ \
 struct { \
-    __uint(type, BPF_MAP_TYPE_HASH); \
+    __uint(type, BPF_MAP_TYPE_ARRAY); \
     __uint(max_entries, 1024); \
     __type(key, __u32); \
     __type(value, struct sync_timer_state); \
 } sync_timer_states_##timer_name SEC(".maps"); \
 \
-/* Init status map */ \
+/* Init status map, also indexed by CPU id */ \
 struct { \
-    __uint(type, BPF_MAP_TYPE_HASH); \
+    __uint(type, BPF_MAP_TYPE_ARRAY); \
     __uint(max_entries, 1024); \
     __type(key, __u32); \
     __type(value, __u8); \
@@ -80,11 +80,13 @@ func (st *SyncTimer) Start() error {
 
 // Stop cleans up the synchronized timer system
 func (st *SyncTimer) Stop() {
-	// Reset all timer states to stop the timers
+	// Timer state lives in array maps whose entries cannot be deleted; the
+	// kernel cancels the timers when the maps are destroyed on close. Just
+	// clear the init flags so a subsequent Start reinitializes.
 	for cpu := 0; cpu < runtime.NumCPU(); cpu++ {
 		key := uint32(cpu)
-		_ = st.timerStates.Delete(key)
-		_ = st.initStatus.Delete(key)
+		var zero uint8
+		_ = st.initStatus.Put(key, zero)
 	}
 }
 